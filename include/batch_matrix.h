@@ -0,0 +1,240 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Пакетные операции над множеством маленьких матриц
+
+#ifndef __BATCH_MATRIX_H__
+#define __BATCH_MATRIX_H__
+
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+
+// Количество матриц пакета, обрабатываемых одним потоком за раз.
+// Внутренние циклы идут по матрицам пакета, поэтому заполняют
+// векторные регистры целиком независимо от порядка матриц
+const size_t BATCH_LANE_CHUNK = 256;
+
+// Пакет матриц -
+// count матриц rows x cols, хранимых в виде структуры массивов:
+// элемент (i, j) всех матриц пакета лежит подряд
+template<typename T>
+class TMatrixBatch
+{
+protected:
+  size_t cnt, nr, nc;
+  vector<T> mem;       // mem[(i * nc + j) * cnt + b] - элемент (i, j) матрицы b
+public:
+  TMatrixBatch(size_t count, size_t rows, size_t cols) : cnt(count), nr(rows), nc(cols)
+  {
+    if (cnt == 0 || nr == 0 || nc == 0)
+      throw out_of_range("Batch sizes should be greater than zero");
+    mem.assign(cnt * nr * nc, T());
+  }
+  TMatrixBatch(size_t count, size_t n) : TMatrixBatch(count, n, n) {}
+
+  size_t count() const noexcept { return cnt; }
+  size_t rows() const noexcept { return nr; }
+  size_t cols() const noexcept { return nc; }
+
+  // элемент (i, j) матрицы b
+  T& operator()(size_t b, size_t i, size_t j) { return mem[(i * nc + j) * cnt + b]; }
+  const T& operator()(size_t b, size_t i, size_t j) const { return mem[(i * nc + j) * cnt + b]; }
+
+  // указатель на элементы (i, j) всех матриц пакета
+  T* lanes(size_t i, size_t j) { return mem.data() + (i * nc + j) * cnt; }
+  const T* lanes(size_t i, size_t j) const { return mem.data() + (i * nc + j) * cnt; }
+
+  bool operator==(const TMatrixBatch& m) const
+  {
+    return cnt == m.cnt && nr == m.nr && nc == m.nc && mem == m.mem;
+  }
+  bool operator!=(const TMatrixBatch& m) const { return !(*this == m); }
+};
+
+// C[b] = A[b] * B[b] для всех матриц пакета
+template<typename T>
+void batch_gemm(const TMatrixBatch<T>& a, const TMatrixBatch<T>& b, TMatrixBatch<T>& c)
+{
+  size_t cnt = a.count(), m = a.rows(), p = a.cols(), n = b.cols();
+  if (b.count() != cnt || c.count() != cnt || b.rows() != p || c.rows() != m || c.cols() != n)
+    throw invalid_argument("batch sizes don't match");
+  long long chunks = (long long)((cnt + BATCH_LANE_CHUNK - 1) / BATCH_LANE_CHUNK);
+#pragma omp parallel for schedule(static)
+  for (long long ch = 0; ch < chunks; ch++) {
+    size_t b0 = ch * BATCH_LANE_CHUNK, b1 = min(cnt, b0 + BATCH_LANE_CHUNK);
+    for (size_t i = 0; i < m; i++)
+      for (size_t j = 0; j < n; j++) {
+        T* cij = c.lanes(i, j);
+        for (size_t l = b0; l < b1; l++)
+          cij[l] = T();
+        for (size_t k = 0; k < p; k++) {
+          const T* aik = a.lanes(i, k);
+          const T* bkj = b.lanes(k, j);
+          for (size_t l = b0; l < b1; l++)
+            cij[l] += aik[l] * bkj[l];
+        }
+      }
+  }
+}
+
+// y[b] = A[b] * x[b]; x и y - пакеты векторов-столбцов
+template<typename T>
+void batch_gemv(const TMatrixBatch<T>& a, const TMatrixBatch<T>& x, TMatrixBatch<T>& y)
+{
+  if (x.cols() != 1 || y.cols() != 1)
+    throw invalid_argument("batch gemv expects column vectors");
+  batch_gemm(a, x, y);
+}
+
+// LU-разложение с частичным выбором ведущего элемента для каждой матрицы пакета.
+// Множители L (без единичной диагонали) и U записываются на место A,
+// piv[k * count + b] - номер строки, переставленной с k-й в матрице b.
+// Возвращает количество вырожденных матриц; для них разложение не завершается
+// (нулевой ведущий элемент дает нулевые множители)
+template<typename T>
+size_t batch_lu(TMatrixBatch<T>& a, vector<size_t>& piv)
+{
+  size_t cnt = a.count(), n = a.rows();
+  if (a.cols() != n)
+    throw invalid_argument("batch LU requires square matrices");
+  piv.assign(n * cnt, 0);
+  size_t singular = 0;
+  long long chunks = (long long)((cnt + BATCH_LANE_CHUNK - 1) / BATCH_LANE_CHUNK);
+#pragma omp parallel for schedule(static) reduction(+:singular)
+  for (long long ch = 0; ch < chunks; ch++) {
+    size_t b0 = ch * BATCH_LANE_CHUNK, b1 = min(cnt, b0 + BATCH_LANE_CHUNK);
+    vector<T> best(b1 - b0), inv(b1 - b0);
+    vector<bool> dead(b1 - b0, false);
+    for (size_t k = 0; k < n; k++) {
+      size_t* pk = piv.data() + k * cnt;
+      // поиск ведущего элемента в столбце k
+      const T* akk = a.lanes(k, k);
+      for (size_t l = b0; l < b1; l++) {
+        best[l - b0] = abs(akk[l]);
+        pk[l] = k;
+      }
+      for (size_t i = k + 1; i < n; i++) {
+        const T* aik = a.lanes(i, k);
+        for (size_t l = b0; l < b1; l++)
+          if (abs(aik[l]) > best[l - b0]) {
+            best[l - b0] = abs(aik[l]);
+            pk[l] = i;
+          }
+      }
+      // перестановка строк
+      for (size_t j = 0; j < n; j++) {
+        T* akj = a.lanes(k, j);
+        for (size_t l = b0; l < b1; l++)
+          if (pk[l] != k)
+            std::swap(akj[l], a(l, pk[l], j));
+      }
+      for (size_t l = b0; l < b1; l++) {
+        if (akk[l] == T()) {
+          inv[l - b0] = T();
+          if (!dead[l - b0]) {
+            dead[l - b0] = true;
+            singular++;
+          }
+        }
+        else
+          inv[l - b0] = T(1) / akk[l];
+      }
+      // исключение
+      for (size_t i = k + 1; i < n; i++) {
+        T* aik = a.lanes(i, k);
+        for (size_t l = b0; l < b1; l++)
+          aik[l] *= inv[l - b0];
+        for (size_t j = k + 1; j < n; j++) {
+          T* aij = a.lanes(i, j);
+          const T* akj = a.lanes(k, j);
+          for (size_t l = b0; l < b1; l++)
+            aij[l] -= aik[l] * akj[l];
+        }
+      }
+    }
+  }
+  return singular;
+}
+
+// Решение систем A[b] X[b] = B[b] по разложению из batch_lu; X записывается на место B
+template<typename T>
+void batch_lu_solve(const TMatrixBatch<T>& lu, const vector<size_t>& piv, TMatrixBatch<T>& rhs)
+{
+  size_t cnt = lu.count(), n = lu.rows(), m = rhs.cols();
+  if (rhs.count() != cnt || rhs.rows() != n || piv.size() != n * cnt)
+    throw invalid_argument("batch sizes don't match");
+  long long chunks = (long long)((cnt + BATCH_LANE_CHUNK - 1) / BATCH_LANE_CHUNK);
+#pragma omp parallel for schedule(static)
+  for (long long ch = 0; ch < chunks; ch++) {
+    size_t b0 = ch * BATCH_LANE_CHUNK, b1 = min(cnt, b0 + BATCH_LANE_CHUNK);
+    for (size_t k = 0; k < n; k++) {
+      const size_t* pk = piv.data() + k * cnt;
+      for (size_t j = 0; j < m; j++) {
+        T* bkj = rhs.lanes(k, j);
+        for (size_t l = b0; l < b1; l++)
+          if (pk[l] != k)
+            std::swap(bkj[l], rhs(l, pk[l], j));
+      }
+    }
+    // прямой ход: L Y = P B
+    for (size_t i = 1; i < n; i++)
+      for (size_t k = 0; k < i; k++) {
+        const T* lik = lu.lanes(i, k);
+        for (size_t j = 0; j < m; j++) {
+          T* bij = rhs.lanes(i, j);
+          const T* bkj = rhs.lanes(k, j);
+          for (size_t l = b0; l < b1; l++)
+            bij[l] -= lik[l] * bkj[l];
+        }
+      }
+    // обратный ход: U X = Y
+    for (size_t i = n; i-- > 0;) {
+      for (size_t k = i + 1; k < n; k++) {
+        const T* uik = lu.lanes(i, k);
+        for (size_t j = 0; j < m; j++) {
+          T* bij = rhs.lanes(i, j);
+          const T* bkj = rhs.lanes(k, j);
+          for (size_t l = b0; l < b1; l++)
+            bij[l] -= uik[l] * bkj[l];
+        }
+      }
+      const T* uii = lu.lanes(i, i);
+      for (size_t j = 0; j < m; j++) {
+        T* bij = rhs.lanes(i, j);
+        for (size_t l = b0; l < b1; l++)
+          bij[l] /= uii[l];
+      }
+    }
+  }
+}
+
+// Решение систем A[b] X[b] = B[b]; A и B не изменяются
+template<typename T>
+TMatrixBatch<T> batch_solve(const TMatrixBatch<T>& a, const TMatrixBatch<T>& rhs)
+{
+  TMatrixBatch<T> lu(a), x(rhs);
+  vector<size_t> piv;
+  if (batch_lu(lu, piv) != 0)
+    throw runtime_error("batch contains singular matrices");
+  batch_lu_solve(lu, piv, x);
+  return x;
+}
+
+// Обращение всех матриц пакета
+template<typename T>
+TMatrixBatch<T> batch_inverse(const TMatrixBatch<T>& a)
+{
+  size_t n = a.rows();
+  TMatrixBatch<T> e(a.count(), n, n);
+  for (size_t i = 0; i < n; i++) {
+    T* eii = e.lanes(i, i);
+    for (size_t l = 0; l < a.count(); l++)
+      eii[l] = T(1);
+  }
+  return batch_solve(a, e);
+}
+
+#endif
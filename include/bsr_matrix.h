@@ -0,0 +1,281 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Блочное сжатое хранение по строкам (BSR) с плотными блоками B x B
+
+#ifndef __BSR_MATRIX_H__
+#define __BSR_MATRIX_H__
+
+#include "dop_matrix.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Число блочных строк, начиная с которого умножения выполняются параллельно
+const size_t BSR_PARALLEL_SIZE = 2048;
+// Ширина полосы столбцов X, для которой SpMM держит блок результата B x W в регистрах
+const size_t BSR_SPMM_WIDTH = 8;
+
+// Микроядра. Размер блока известен при компиляции, и свертки по
+// index_sequence разворачиваются в прямой код из B * B умножений,
+// который компилятор векторизует без циклов и проверок границ
+
+// a[0..B) * x[0..B)
+template<typename T, size_t... C>
+inline T bsr_row_dot(const T* a, const T* x, index_sequence<C...>)
+{
+  return ((a[C] * x[C]) + ...);
+}
+
+// y[0..B) += A x для блока A, хранимого по строкам
+template<typename T, size_t B, size_t... R>
+inline void bsr_block_mv(const T* a, const T* x, T* y, index_sequence<R...>)
+{
+  ((y[R] += bsr_row_dot(a + R * B, x, make_index_sequence<B>())), ...);
+}
+
+// acc[B][W] += A X, где X - B строк по W элементов с шагом ldx
+template<typename T, size_t B, size_t W>
+inline void bsr_block_mm(const T* a, const T* x, size_t ldx, T (&acc)[B][W])
+{
+  for (size_t c = 0; c < B; c++) {
+    const T* xc = x + c * ldx;
+    for (size_t r = 0; r < B; r++) {
+      const T arc = a[r * B + c];
+      for (size_t j = 0; j < W; j++)
+        acc[r][j] += arc * xc[j];
+    }
+  }
+}
+
+// Блочная CSR-матрица -
+// ненулевые блоки B x B хранятся подряд, внутри блока по строкам, и на
+// весь блок приходится один номер столбца. Размеры матрицы кратны B
+template<typename T, size_t B>
+class TBSRMatrix
+{
+  static_assert(B > 0, "block size must be positive");
+
+  int mb, nb;                         // число блочных строк и столбцов
+  TTrackedVector<T> values;           // блоки по B * B значений
+  TTrackedVector<int> block_cols;     // блочные номера столбцов
+  TTrackedVector<int> block_index;    // начала блочных строк
+
+  // SpMM для блочных строк [0, mb) и полосы столбцов [j0, j0 + W)
+  template<size_t W>
+  void multiply_strip(const T* x, size_t ldx, T* y, size_t ldy, size_t j0) const
+  {
+#pragma omp parallel for schedule(static) if (size_t(mb) >= BSR_PARALLEL_SIZE)
+    for (int bi = 0; bi < mb; bi++) {
+      T acc[B][W] = {};
+      for (int k = block_index[bi]; k < block_index[bi + 1]; k++)
+        bsr_block_mm<T, B, W>(values.data() + size_t(k) * B * B, x + size_t(block_cols[k]) * B * ldx + j0, ldx, acc);
+      for (size_t r = 0; r < B; r++) {
+        T* yr = y + (size_t(bi) * B + r) * ldy + j0;
+        for (size_t j = 0; j < W; j++)
+          yr[j] = acc[r][j];
+      }
+    }
+  }
+public:
+  static constexpr size_t block_size = B;
+
+  TBSRMatrix(int block_rows, int block_columns) : mb(block_rows), nb(block_columns)
+  {
+    if (mb <= 0 || nb <= 0 || size_t(mb) * B > MAX_MATRIX_SIZE || size_t(nb) * B > MAX_MATRIX_SIZE)
+      throw out_of_range("invalid size");
+    block_index.assign(size_t(mb) + 1, 0);
+  }
+  // из готовых массивов BSR, которые перемещаются в матрицу без копирования
+  TBSRMatrix(int block_rows, int block_columns, TTrackedVector<int>&& block_index,
+             TTrackedVector<int>&& block_cols, TTrackedVector<T>&& values) : mb(block_rows), nb(block_columns)
+  {
+    if (mb <= 0 || nb <= 0 || size_t(mb) * B > MAX_MATRIX_SIZE || size_t(nb) * B > MAX_MATRIX_SIZE)
+      throw out_of_range("invalid size");
+    if (values.size() != block_cols.size() * B * B)
+      throw invalid_argument("compressed arrays sizes don't match");
+    check_compressed(mb, nb, block_index, block_cols, block_cols.size());
+    this->block_index = move(block_index);
+    this->block_cols = move(block_cols);
+    this->values = move(values);
+  }
+  // Из CSR-матрицы с размерами, кратными B: блок хранится, если в нем есть
+  // хотя бы один элемент. Первый проход считает блоки в блочных строках,
+  // второй раскладывает элементы; блоки в строке упорядочены по столбцам
+  explicit TBSRMatrix(const TCSRMatrix<T>& a) : mb(a.get_rows() / int(B)), nb(a.get_cols() / int(B))
+  {
+    if (a.get_rows() % int(B) != 0 || a.get_cols() % int(B) != 0)
+      throw invalid_argument("matrix sizes must be multiples of the block size");
+    const int* ptr = a.row_index_data();
+    const int* col = a.col_indices_data();
+    const T* val = a.values_data();
+    block_index.assign(size_t(mb) + 1, 0);
+    const bool parallel = size_t(mb) >= BSR_PARALLEL_SIZE;
+#pragma omp parallel if (parallel)
+    {
+      // mark[bj] - номер последней блочной строки, где встретился столбец bj
+      vector<int> mark(nb, -1);
+#pragma omp for schedule(static)
+      for (int bi = 0; bi < mb; bi++) {
+        int count = 0;
+        for (int k = ptr[bi * B]; k < ptr[(bi + 1) * B]; k++) {
+          int bj = col[k] / int(B);
+          if (mark[bj] != bi) {
+            mark[bj] = bi;
+            count++;
+          }
+        }
+        block_index[bi + 1] = count;
+      }
+    }
+    for (int bi = 0; bi < mb; bi++)
+      block_index[bi + 1] += block_index[bi];
+    block_cols.resize(block_index[mb]);
+    values.resize(size_t(block_index[mb]) * B * B);
+#pragma omp parallel if (parallel)
+    {
+      // slot[bj] - позиция блока bj в текущей блочной строке
+      vector<int> slot(nb, -1);
+#pragma omp for schedule(static)
+      for (int bi = 0; bi < mb; bi++) {
+        int* cols = block_cols.data() + block_index[bi];
+        int count = 0;
+        for (int k = ptr[bi * B]; k < ptr[(bi + 1) * B]; k++) {
+          int bj = col[k] / int(B);
+          if (slot[bj] < 0) {
+            slot[bj] = 0;
+            cols[count++] = bj;
+          }
+        }
+        sort(cols, cols + count);
+        for (int s = 0; s < count; s++)
+          slot[cols[s]] = block_index[bi] + s;
+        for (size_t r = 0; r < B; r++) {
+          size_t i = size_t(bi) * B + r;
+          for (int k = ptr[i]; k < ptr[i + 1]; k++)
+            values[size_t(slot[col[k] / int(B)]) * B * B + r * B + size_t(col[k]) % B] = val[k];
+        }
+        for (int s = 0; s < count; s++)
+          slot[cols[s]] = -1;
+      }
+    }
+  }
+
+  // CSR-матрица без нулей, хранившихся внутри блоков
+  TCSRMatrix<T> to_csr() const
+  {
+    int rows = get_rows();
+    TTrackedVector<int> ptr(size_t(rows) + 1, 0);
+    const bool parallel = size_t(mb) >= BSR_PARALLEL_SIZE;
+#pragma omp parallel for schedule(static) if (parallel)
+    for (int i = 0; i < rows; i++) {
+      int bi = i / int(B), count = 0;
+      for (int k = block_index[bi]; k < block_index[bi + 1]; k++) {
+        const T* row = values.data() + size_t(k) * B * B + size_t(i % int(B)) * B;
+        for (size_t c = 0; c < B; c++)
+          count += row[c] != T(0);
+      }
+      ptr[i + 1] = count;
+    }
+    for (int i = 0; i < rows; i++)
+      ptr[i + 1] += ptr[i];
+    TTrackedVector<int> col(ptr[rows]);
+    TTrackedVector<T> val(ptr[rows]);
+#pragma omp parallel for schedule(static) if (parallel)
+    for (int i = 0; i < rows; i++) {
+      int bi = i / int(B), p = ptr[i];
+      for (int k = block_index[bi]; k < block_index[bi + 1]; k++) {
+        const T* row = values.data() + size_t(k) * B * B + size_t(i % int(B)) * B;
+        for (size_t c = 0; c < B; c++)
+          if (row[c] != T(0)) {
+            col[p] = block_cols[k] * int(B) + int(c);
+            val[p++] = row[c];
+          }
+      }
+    }
+    return TCSRMatrix<T>(rows, get_cols(), move(ptr), move(col), move(val));
+  }
+
+  int get_rows() const noexcept { return mb * int(B); }
+  int get_cols() const noexcept { return nb * int(B); }
+  int get_block_rows() const noexcept { return mb; }
+  int get_block_cols() const noexcept { return nb; }
+  int non_zero_blocks() const noexcept { return int(block_cols.size()); }
+  const int* block_index_data() const noexcept { return block_index.data(); }
+  const int* block_cols_data() const noexcept { return block_cols.data(); }
+  const T* values_data() const noexcept { return values.data(); }
+
+  T get(int i, int j) const
+  {
+    if (i < 0 || i >= get_rows() || j < 0 || j >= get_cols())
+      throw out_of_range("invalid index");
+    int bi = i / int(B), bj = j / int(B);
+    for (int k = block_index[bi]; k < block_index[bi + 1]; k++)
+      if (block_cols[k] == bj)
+        return values[size_t(k) * B * B + size_t(i % int(B)) * B + size_t(j % int(B))];
+    return T();
+  }
+  T operator()(int i, int j) const { return get(i, j); }
+
+  // y = A * x; x - массив длины cols, y - длины rows.
+  // На блок читается один номер столбца и B элементов x
+  void multiply(const T* x, T* y) const
+  {
+#pragma omp parallel for schedule(static) if (size_t(mb) >= BSR_PARALLEL_SIZE)
+    for (int bi = 0; bi < mb; bi++) {
+      T acc[B] = {};
+      for (int k = block_index[bi]; k < block_index[bi + 1]; k++)
+        bsr_block_mv<T, B>(values.data() + size_t(k) * B * B, x + size_t(block_cols[k]) * B, acc,
+                           make_index_sequence<B>());
+      for (size_t r = 0; r < B; r++)
+        y[size_t(bi) * B + r] = acc[r];
+    }
+  }
+  TDynamicVector<T> operator*(const TDynamicVector<T>& v) const
+  {
+    if (size_t(get_cols()) != v.size())
+      throw invalid_argument("all sizes don't match");
+    TDynamicVector<T> result(get_rows());
+    multiply(v.data(), result.data());
+    return result;
+  }
+
+  // Y = A * X для k столбцов: X - cols строк, Y - rows строк, строки
+  // идут с шагами ldx и ldy. Столбцы обрабатываются полосами по
+  // BSR_SPMM_WIDTH, и блок результата накапливается в регистрах
+  void multiply(const T* x, size_t ldx, T* y, size_t ldy, size_t k) const
+  {
+    size_t j0 = 0;
+    for (; j0 + BSR_SPMM_WIDTH <= k; j0 += BSR_SPMM_WIDTH)
+      multiply_strip<BSR_SPMM_WIDTH>(x, ldx, y, ldy, j0);
+    for (; j0 < k; j0++)
+      multiply_strip<1>(x, ldx, y, ldy, j0);
+  }
+  TDynamicMatrix<T> operator*(const TDynamicMatrix<T>& m) const
+  {
+    size_t n = m.size();
+    if (size_t(get_rows()) != n || size_t(get_cols()) != n)
+      throw invalid_argument("matrix sizes must match for multiplication");
+    // строки матриц хранятся раздельно, поэтому X и Y собираются в непрерывные буферы
+    vector<T> x(n * n), y(n * n);
+    for (size_t i = 0; i < n; i++)
+      copy_n(m[i].data(), n, x.data() + i * n);
+    multiply(x.data(), n, y.data(), n, n);
+    TDynamicMatrix<T> result(n);
+    for (size_t i = 0; i < n; i++)
+      copy_n(y.data() + i * n, n, result[i].data());
+    return result;
+  }
+
+  // объем памяти в байтах, массивы - по выделенной емкости
+  size_t memory_bytes() const noexcept
+  {
+    return sizeof(*this) + heap_block_bytes(values.capacity() * sizeof(T), alignof(T))
+        + heap_block_bytes(block_cols.capacity() * sizeof(int), alignof(int))
+        + heap_block_bytes(block_index.capacity() * sizeof(int), alignof(int));
+  }
+};
+
+#endif
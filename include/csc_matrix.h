@@ -0,0 +1,207 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Сжатое хранение по столбцам (CSC) и транспонирование сжатых матриц
+
+#ifndef __CSC_MATRIX_H__
+#define __CSC_MATRIX_H__
+
+#include "dop_matrix.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+// Наибольшее число полос строк при параллельном транспонировании
+const size_t TRANSPOSE_MAX_CHUNKS = 64;
+
+// Транспонирование сжатой матрицы сортировкой подсчетом за O(nnz + inner):
+// строки (outer, inner) со ссылками ptr, idx, val переходят в массивы
+// tptr (inner + 1), tidx, tval (nnz). CSR матрицы A так превращается в CSC A,
+// и наоборот. Строки делятся на полосы с примерно равным числом элементов;
+// каждая полоса считает свои элементы по столбцам, после чего для пары
+// (полоса, столбец) известно место записи, и полосы раскладывают элементы
+// параллельно. Внутри столбца элементы идут по возрастанию номера строки
+template<typename T>
+void sparse_transpose(int outer, int inner, const int* ptr, const int* idx, const T* val,
+                      int* tptr, int* tidx, T* tval)
+{
+  const size_t nnz = size_t(ptr[outer]);
+  const size_t chunks = max<size_t>(1, min({ TRANSPOSE_MAX_CHUNKS, size_t(outer), nnz / CONVERT_PARALLEL_SIZE }));
+  vector<int> first(chunks + 1);
+  for (size_t t = 0; t <= chunks; t++)
+    first[t] = int(lower_bound(ptr, ptr + outer, int(nnz * t / chunks)) - ptr);
+  first[chunks] = outer;
+  // count[t * inner + j] - число элементов полосы t в столбце j
+  vector<int> count(chunks * size_t(inner), 0);
+  const bool parallel = chunks > 1;
+#pragma omp parallel for schedule(static) if (parallel)
+  for (long long t = 0; t < (long long)chunks; t++) {
+    int* c = count.data() + size_t(t) * inner;
+    for (int k = ptr[first[t]]; k < ptr[first[t + 1]]; k++)
+      c[idx[k]]++;
+  }
+  // count становится смещением полосы внутри столбца
+#pragma omp parallel for schedule(static) if (parallel && size_t(inner) * chunks > CONVERT_PARALLEL_SIZE)
+  for (int j = 0; j < inner; j++) {
+    int sum = 0;
+    for (size_t t = 0; t < chunks; t++) {
+      int c = count[t * inner + j];
+      count[t * inner + j] = sum;
+      sum += c;
+    }
+    tptr[j + 1] = sum;
+  }
+  tptr[0] = 0;
+  for (int j = 0; j < inner; j++)
+    tptr[j + 1] += tptr[j];
+#pragma omp parallel for schedule(static) if (parallel)
+  for (long long t = 0; t < (long long)chunks; t++) {
+    int* c = count.data() + size_t(t) * inner;
+    for (int i = first[t]; i < first[t + 1]; i++)
+      for (int k = ptr[i]; k < ptr[i + 1]; k++) {
+        int pos = tptr[idx[k]] + c[idx[k]]++;
+        tidx[pos] = i;
+        tval[pos] = val[k];
+      }
+  }
+}
+
+// Сжатое хранение по столбцам - ненулевые элементы каждого столбца подряд.
+// Дополняет TCSRMatrix: выборка столбцов и A^T x обходят столбцы непрерывно
+template<typename T>
+class TCSCMatrix
+{
+  int nr, nc;
+  TTrackedVector<T> values;        // ненулевые значения
+  TTrackedVector<int> row_indices; // номера строк
+  TTrackedVector<int> col_index;   // начала столбцов
+public:
+  TCSCMatrix(int r, int c) : nr(r), nc(c)
+  {
+    if (r <= 0 || c <= 0 || r > MAX_MATRIX_SIZE || c > MAX_MATRIX_SIZE)
+      throw out_of_range("invalid size");
+    col_index.assign(size_t(c) + 1, 0);
+  }
+  // из готовых массивов CSC, которые перемещаются в матрицу без копирования
+  TCSCMatrix(int r, int c, TTrackedVector<int>&& col_index, TTrackedVector<int>&& row_indices,
+             TTrackedVector<T>&& values) : nr(r), nc(c)
+  {
+    if (r <= 0 || c <= 0 || r > MAX_MATRIX_SIZE || c > MAX_MATRIX_SIZE)
+      throw out_of_range("invalid size");
+    check_compressed(c, r, col_index, row_indices, values.size());
+    this->col_index = move(col_index);
+    this->row_indices = move(row_indices);
+    this->values = move(values);
+  }
+  // та же матрица, что a, в хранении по столбцам
+  explicit TCSCMatrix(const TCSRMatrix<T>& a) : nr(a.get_rows()), nc(a.get_cols())
+  {
+    size_t nnz = size_t(a.non_zeros());
+    col_index.resize(size_t(nc) + 1);
+    row_indices.resize(nnz);
+    values.resize(nnz);
+    sparse_transpose(nr, nc, a.row_index_data(), a.col_indices_data(), a.values_data(),
+                     col_index.data(), row_indices.data(), values.data());
+  }
+
+  TCSRMatrix<T> to_csr() const
+  {
+    TTrackedVector<int> ptr(size_t(nr) + 1), idx(values.size());
+    TTrackedVector<T> val(values.size());
+    sparse_transpose(nc, nr, col_index.data(), row_indices.data(), values.data(),
+                     ptr.data(), idx.data(), val.data());
+    return TCSRMatrix<T>(nr, nc, move(ptr), move(idx), move(val));
+  }
+
+  int get_rows() const noexcept { return nr; }
+  int get_cols() const noexcept { return nc; }
+  int non_zeros() const noexcept { return int(values.size()); }
+  const int* col_index_data() const noexcept { return col_index.data(); }
+  const int* row_indices_data() const noexcept { return row_indices.data(); }
+  const T* values_data() const noexcept { return values.data(); }
+
+  T get(int i, int j) const
+  {
+    if (i < 0 || i >= nr || j < 0 || j >= nc)
+      throw out_of_range("invalid index");
+    for (int k = col_index[j]; k < col_index[j + 1]; k++)
+      if (row_indices[k] == i)
+        return values[k];
+    return T();
+  }
+  T operator()(int i, int j) const { return get(i, j); }
+
+  // столбец j в плотном виде
+  TDynamicVector<T> column(int j) const
+  {
+    if (j < 0 || j >= nc)
+      throw out_of_range("invalid index");
+    TDynamicVector<T> result(nr);
+    for (int k = col_index[j]; k < col_index[j + 1]; k++)
+      result[row_indices[k]] = values[k];
+    return result;
+  }
+
+  // y = A * x по столбцам; x - массив длины cols, y - длины rows.
+  // Столбцы пишут в общие элементы y, поэтому обход последовательный
+  void multiply(const T* x, T* y) const
+  {
+    fill(y, y + nr, T(0));
+    for (int j = 0; j < nc; j++) {
+      const T xj = x[j];
+      for (int k = col_index[j]; k < col_index[j + 1]; k++)
+        y[row_indices[k]] += values[k] * xj;
+    }
+  }
+  TDynamicVector<T> operator*(const TDynamicVector<T>& v) const
+  {
+    if (size_t(nc) != v.size())
+      throw invalid_argument("all sizes don't match");
+    TDynamicVector<T> result(nr);
+    multiply(v.data(), result.data());
+    return result;
+  }
+  // A^T x - скалярные произведения столбцов на x, независимые друг от друга;
+  // порог параллельности тот же, что у умножения CSR на вектор
+  friend TDynamicVector<T> operator*(const TTransposed<TCSCMatrix>& at, const TDynamicVector<T>& v)
+  {
+    const TCSCMatrix& m = at.m;
+    if (size_t(m.nr) != v.size())
+      throw invalid_argument("all sizes don't match");
+    TDynamicVector<T> result(m.nc);
+    T* y = result.data();
+    const T* x = v.data();
+#pragma omp parallel for schedule(static) if (m.values.size() >= CSR_SPMV_PARALLEL_SIZE)
+    for (int j = 0; j < m.nc; j++) {
+      T sum = T(0);
+      for (int k = m.col_index[j]; k < m.col_index[j + 1]; k++)
+        sum += m.values[k] * x[m.row_indices[k]];
+      y[j] = sum;
+    }
+    return result;
+  }
+
+  // объем памяти в байтах, массивы - по выделенной емкости
+  size_t memory_bytes() const noexcept
+  {
+    return sizeof(*this) + heap_block_bytes(values.capacity() * sizeof(T), alignof(T))
+        + heap_block_bytes(row_indices.capacity() * sizeof(int), alignof(int))
+        + heap_block_bytes(col_index.capacity() * sizeof(int), alignof(int));
+  }
+};
+
+// A^T в хранении по строкам
+template<typename T>
+TCSRMatrix<T> transpose(const TCSRMatrix<T>& a)
+{
+  int r = a.get_rows(), c = a.get_cols();
+  size_t nnz = size_t(a.non_zeros());
+  TTrackedVector<int> ptr(size_t(c) + 1), idx(nnz);
+  TTrackedVector<T> val(nnz);
+  sparse_transpose(r, c, a.row_index_data(), a.col_indices_data(), a.values_data(),
+                   ptr.data(), idx.data(), val.data());
+  return TCSRMatrix<T>(c, r, move(ptr), move(idx), move(val));
+}
+
+#endif
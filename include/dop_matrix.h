@@ -6,10 +6,15 @@
 #include <stdexcept>
 #include <cmath>
 #include <iomanip>
+#include <limits>
+#include <numeric>
 using namespace std;
 
 //const int MAX_MATRIX_SIZE = 1000;
 
+// ,       
+const size_t CONVERT_PARALLEL_SIZE = 1 << 16;
+
 //  - ,            .
 //
 //[a1 a2 0 0]            [0  a1 a2]             general band matrix
@@ -24,28 +29,34 @@ protected:
     int lower_bandwidth;   //-   
     int upper_bandwidth;   //-   
     //   (   )
-    vector<TDynamicVector<T>> diagonals;  //  
+    vector<TDynamicVector<T>, TTrackingAllocator<TDynamicVector<T>>> diagonals;  //  
 public:
     TGeneralBandMatrix(int n, int lbw = 0, int ubw = 0) : TDynamicMatrix<T>(n), n(n), lower_bandwidth(lbw), upper_bandwidth(ubw) {
+        create_diagonals();
+    }
+private:
+    template<typename> friend class TCSRMatrix;
+    struct TBandOnly {};
+    //    n x n   (   1):
+    // ,    
+    TGeneralBandMatrix(TBandOnly, int n, int lbw, int ubw) : TDynamicMatrix<T>(1), n(n), lower_bandwidth(lbw), upper_bandwidth(ubw) {
+        create_diagonals();
+    }
+    void create_diagonals() {
         if (n == 0 || n > MAX_MATRIX_SIZE)
             throw ("wrong size");
-        if (lbw >= n || ubw >= n)
+        if (lower_bandwidth >= n || upper_bandwidth >= n)
             throw ("bandwidth must be less, than matrix size");
-        //  
-        int total_diagonals = lbw + ubw + 1; //+1  
+        //  ;  TDynamicVector    
+        int total_diagonals = lower_bandwidth + upper_bandwidth + 1; //+1  
         diagonals.resize(total_diagonals);   //  , diagonals[0], diagonals[1], diagonals[2] 
         for (int d = 0; d < total_diagonals; ++d) {
-            int diag_offset = d - lbw; //     (-lbw, ..., 0, ..., +ubw)
+            int diag_offset = d - lower_bandwidth; //     (-lbw, ..., 0, ..., +ubw)
             int diag_length = n - abs(diag_offset);
             diagonals[d] = TDynamicVector<T>(diag_length);
         }
-        //  
-        for (auto& diag : diagonals) {
-            for (int i = 0; i < diag.size(); i++) {
-                diag[i] = T(0);
-            }
-        }
     }
+public:
     //  
     T& operator()(int i, int j) {
         int diff = j - i;
@@ -68,7 +79,7 @@ public:
         else {
             pos_in_diag = i + diff;
         }
-        return diagonals[diag_index][pos_in_diag];
+        return diagonals[diag_index].data()[pos_in_diag];
     }
 
     //  
@@ -88,6 +99,8 @@ public:
         if (n != m.n) {
             throw ("Matrix sizes must match for multiplication");
         }
+        TMATRIX_OP(BandMultiply, 2 * size_t(n) * n * n, (band_elements() + m.band_elements()) * sizeof(T),
+                   size_t(n) * n * sizeof(T));
         //      
         TGeneralBandMatrix<T> result(n, n - 1, n - 1);
         for (int i = 0; i < n; ++i) {
@@ -123,6 +136,95 @@ public:
         return result;
     }
 
+    //   
+    size_t band_elements() const {
+        size_t count = 0;
+        for (const auto& diag : diagonals) count += diag.size();
+        return count;
+    }
+    //   .      
+    // TDynamicMatrix   n x n,   
+    //(   TCSRMatrix::to_band -  1 x 1)
+    size_t memory_bytes() const {
+        return sizeof(*this) + band_heap_bytes();
+    }
+    int lower_band() const { return lower_bandwidth; }
+    int upper_band() const { return upper_bandwidth; }
+    //   offset = j - i;  (i, i + offset)    min(i, i + offset)
+    const T* diagonal_data(int offset) const { return diagonals[lower_bandwidth + offset].data(); }
+    T* diagonal_data(int offset) { return diagonals[lower_bandwidth + offset].data(); }
+    // (i, i + offset)  ,  
+    T band_value(int i, int offset) const {
+        return diagonals[lower_bandwidth + offset][offset > 0 ? i : i + offset];
+    }
+    // ;   
+    TDynamicMatrix<T> to_dense() const {
+        return dense_of(*this);
+    }
+protected:
+    //    m.band_value:   
+    //    
+    template<class Band>
+    static TDynamicMatrix<T> dense_of(const Band& m) {
+        int n = m.n, lbw = m.lower_bandwidth, ubw = m.upper_bandwidth;
+        TDynamicMatrix<T> result(n);
+        vector<T*> rows(n);
+        for (int i = 0; i < n; ++i) rows[i] = result[i].data();
+#pragma omp parallel for schedule(static) if (size_t(n) * n > CONVERT_PARALLEL_SIZE)
+        for (int i = 0; i < n; ++i) {
+            for (int offset = max(-lbw, -i); offset <= min(ubw, n - 1 - i); ++offset) {
+                rows[i][i + offset] = m.band_value(i, offset);
+            }
+        }
+        return result;
+    }
+    size_t band_heap_bytes() const {
+        size_t bytes = TDynamicMatrix<T>::heap_bytes();
+        bytes += heap_block_bytes(diagonals.capacity() * sizeof(TDynamicVector<T>), alignof(TDynamicVector<T>));
+        for (const auto& diag : diagonals) bytes += owned_heap_bytes(diag);
+        return bytes;
+    }
+public:
+    //    , y = A * x; x  y -   n.
+    //    y,      Acc  y:
+    //  float  y  double    ,   double
+    template<typename Acc>
+    void multiply(const T* x, Acc* y) const {
+        TMATRIX_OP(BandVector, 2 * band_elements(), (band_elements() + n) * sizeof(T), n * sizeof(Acc));
+        for (int i = 0; i < n; ++i) {
+            y[i] = Acc(0);
+        }
+        for (int d = 0; d < (int)diagonals.size(); ++d) {
+            int offset = d - lower_bandwidth;
+            int len = n - abs(offset);
+            const T* diag = diagonals[d].data();
+            if (offset >= 0) {
+                // p     p,  p + offset
+                for (int p = 0; p < len; ++p) {
+                    y[p] += Acc(diag[p]) * Acc(x[p + offset]);
+                }
+            }
+            else {
+                // p     p - offset,  p
+                for (int p = 0; p < len; ++p) {
+                    y[p - offset] += Acc(diag[p]) * Acc(x[p]);
+                }
+            }
+        }
+    }
+    template<typename Acc>
+    TDynamicVector<Acc> multiply(const TDynamicVector<T>& v) const {
+        if ((size_t)n != v.size()) {
+            throw invalid_argument("all sizes don't match");
+        }
+        TDynamicVector<Acc> result(n);
+        multiply(v.data(), result.data());
+        return result;
+    }
+    TDynamicVector<T> operator*(const TDynamicVector<T>& v) const {
+        return multiply<T>(v);
+    }
+
     //  
     friend ostream& operator<<(ostream& ostr, const TGeneralBandMatrix& m) {
         ostr << "General Band Matrix " << m.n << "x" << m.n << " (lbw=" << m.lower_bandwidth << ", ubw=" << m.upper_bandwidth << "):" << endl;
@@ -158,6 +260,22 @@ template<typename T>
 class TSymmetricBandMatrix : public TGeneralBandMatrix<T> {
 public:
     TSymmetricBandMatrix(int n, int bandwidth) : TGeneralBandMatrix<T>(n, bandwidth, bandwidth) {}
+private:
+    //   ,      
+    size_t upper_lower_elements() const {
+        size_t count = 0;
+        for (int d = 0; d < this->lower_bandwidth; ++d) count += this->diagonals[d].size();
+        return count;
+    }
+public:
+    // (i, i + offset);     
+    T band_value(int i, int offset) const {
+        return offset >= 0 ? TGeneralBandMatrix<T>::band_value(i, offset)
+                           : TGeneralBandMatrix<T>::band_value(i + offset, -offset);
+    }
+    TDynamicMatrix<T> to_dense() const {
+        return TGeneralBandMatrix<T>::dense_of(*this);
+    }
     T& operator()(int i, int j) {   //         
         if (i > j) {
             return TGeneralBandMatrix<T>::operator()(j, i);  // 
@@ -170,12 +288,51 @@ public:
         }
         return TGeneralBandMatrix<T>::operator()(i, j);
     }
+    //  :    ,   
+    //  -      ; 
+    //  y   Acc
+    template<typename Acc>
+    void multiply(const T* x, Acc* y) const {
+        int n = this->n;
+        //  : upper ,   n 
+        TMATRIX_OP(BandVector, 4 * (this->band_elements() - upper_lower_elements()) - 2 * size_t(n),
+                   (this->band_elements() - upper_lower_elements() + n) * sizeof(T), n * sizeof(Acc));
+        for (int i = 0; i < n; ++i) {
+            y[i] = Acc(0);
+        }
+        for (int offset = 0; offset <= this->upper_bandwidth; ++offset) {
+            int len = n - offset;
+            const T* diag = this->diagonals[this->lower_bandwidth + offset].data();
+            for (int p = 0; p < len; ++p) {
+                y[p] += Acc(diag[p]) * Acc(x[p + offset]);
+            }
+            if (offset > 0) {
+                for (int p = 0; p < len; ++p) {
+                    y[p + offset] += Acc(diag[p]) * Acc(x[p]);
+                }
+            }
+        }
+    }
+    template<typename Acc>
+    TDynamicVector<Acc> multiply(const TDynamicVector<T>& v) const {
+        if ((size_t)this->n != v.size()) {
+            throw invalid_argument("all sizes don't match");
+        }
+        TDynamicVector<Acc> result(this->n);
+        multiply(v.data(), result.data());
+        return result;
+    }
+    TDynamicVector<T> operator*(const TDynamicVector<T>& v) const {
+        return multiply<T>(v);
+    }
     //     
     TSymmetricBandMatrix<T> operator*(const TSymmetricBandMatrix<T>& m) const {
         if (this->n != m.n) {
             throw invalid_argument("matrix sizes must match for multiplication");
         }
         int max_bandwidth = min(this->n - 1, this->lower_bandwidth + m.lower_bandwidth);
+        TMATRIX_OP(BandMultiply, 2 * size_t(this->n) * (max_bandwidth + 1) * (2 * this->upper_bandwidth + 1),
+                   (this->band_elements() + m.band_elements()) * sizeof(T), this->band_elements() * sizeof(T));
         TSymmetricBandMatrix<T> result(this->n, max_bandwidth);
         for (int i = 0; i < this->n; ++i) {
             for (int j = i; j <= min(this->n - 1, i + max_bandwidth); ++j) {
@@ -256,6 +413,8 @@ public:
         }
         //     
         int bandwidth = min(this->n - 1, this->upper_bandwidth + m.upper_bandwidth);
+        TMATRIX_OP(BandMultiply, size_t(this->n) * this->n * this->n / 3,
+                   (this->band_elements() + m.band_elements()) * sizeof(T), size_t(this->n) * this->n * sizeof(T));
         TTriangleBandMatrix<T> result(this->n, bandwidth, this->is_upper);
         for (int i = 0; i < this->n; ++i) {
             for (int j = (this->is_upper ? i : 0); j <= (this->is_upper ? this->n - 1 : i); ++j) {
@@ -292,15 +451,88 @@ public:
     bool is_upper_triangle() const { return is_upper; }
     bool is_lower_triangle() const { return !is_upper; }
     int size() const { return this->sz; }
+    size_t memory_bytes() const { return sizeof(*this) + this->band_heap_bytes(); }
 };
+//    
+const size_t PREFIX_SUM_CHUNK = 1 << 15;
+//   : a[i]  a[0] + ... + a[i].
+//   ,    , 
+//       .
+//     int,  
+inline void prefix_sum(int* a, size_t n) {
+    size_t chunks = (n + PREFIX_SUM_CHUNK - 1) / PREFIX_SUM_CHUNK;
+    vector<long long> offset(chunks + 1, 0);
+#pragma omp parallel for schedule(static) if (chunks > 1)
+    for (long long t = 0; t < (long long)chunks; ++t) {
+        long long sum = 0;
+        for (size_t i = size_t(t) * PREFIX_SUM_CHUNK; i < min(n, size_t(t + 1) * PREFIX_SUM_CHUNK); ++i) sum += a[i];
+        offset[t + 1] = sum;
+    }
+    for (size_t t = 0; t < chunks; ++t) offset[t + 1] += offset[t];
+    if (offset[chunks] > numeric_limits<int>::max()) {
+        throw overflow_error("prefix sum doesn't fit in int");
+    }
+#pragma omp parallel for schedule(static) if (chunks > 1)
+    for (long long t = 0; t < (long long)chunks; ++t) {
+        int sum = int(offset[t]);
+        for (size_t i = size_t(t) * PREFIX_SUM_CHUNK; i < min(n, size_t(t + 1) * PREFIX_SUM_CHUNK); ++i) {
+            sum += a[i];
+            a[i] = sum;
+        }
+    }
+}
+//  : ptr - outer + 1  ,   0,
+//idx -   [0, inner),   ,  
+inline void check_compressed(int outer, int inner, const TTrackedVector<int>& ptr,
+                             const TTrackedVector<int>& idx, size_t nnz) {
+    if (ptr.size() != size_t(outer) + 1 || ptr[0] != 0 || size_t(ptr[outer]) != nnz || idx.size() != nnz) {
+        throw invalid_argument("compressed arrays sizes don't match");
+    }
+    for (int i = 0; i < outer; ++i) {
+        if (ptr[i] > ptr[i + 1]) {
+            throw invalid_argument("compressed pointers must not decrease");
+        }
+    }
+    for (int k : idx) {
+        if (k < 0 || k >= inner) {
+            throw invalid_argument("compressed index out of range");
+        }
+    }
+}
+//   
+enum class TCSROutput { Coordinates, Arrays, Dense };
+//  ,     
+const size_t CSR_DENSE_PRINT_LIMIT = 1000000;
+//   ,    
+//   
+const size_t SPGEMM_PARALLEL_SIZE = 1 << 12;
+// ,        :
+//       
+const int SPGEMM_ROW_CHUNK = 16;
+//  ,     CSR-
+//   
+const size_t CSR_SPMV_PARALLEL_SIZE = 1 << 14;
 //     (CSR) -   
 template<typename T>
 class TCSRMatrix {
 private:
     int rows, cols;
-    vector<T> values;        //  
-    vector<int> col_indices; //  
-    vector<int> row_index;   //  
+    TTrackedVector<T> values;          //  
+    TTrackedVector<int> col_indices;   //  
+    TTrackedVector<int> row_index;     //  
+    //  CSR  
+    size_t memory_arrays() const {
+        return values.size() * (sizeof(T) + sizeof(int)) + (rows + 1) * sizeof(int);
+    }
+    //    :    
+    //   a_ik, b_kj
+    size_t spgemm_flops(const TCSRMatrix& m) const {
+        size_t count = 0;
+        for (size_t k = 0; k < col_indices.size(); ++k) {
+            count += m.row_index[col_indices[k] + 1] - m.row_index[col_indices[k]];
+        }
+        return 2 * count;
+    }
 public:
     TCSRMatrix(int r, int c) : rows(r), cols(c) {
         if (r <= 0 || c <= 0 || r > MAX_MATRIX_SIZE || c > MAX_MATRIX_SIZE) {
@@ -308,10 +540,93 @@ public:
         }
         row_index.resize(rows + 1, 0);
     }
+    //   CSR,      
+    TCSRMatrix(int r, int c, TTrackedVector<int>&& row_index, TTrackedVector<int>&& col_indices,
+               TTrackedVector<T>&& values) : rows(r), cols(c) {
+        if (r <= 0 || c <= 0 || r > MAX_MATRIX_SIZE || c > MAX_MATRIX_SIZE) {
+            throw ("invalid size");
+        }
+        check_compressed(r, c, row_index, col_indices, values.size());
+        this->row_index = move(row_index);
+        this->col_indices = move(col_indices);
+        this->values = move(values);
+    }
+    //  ;   |a_ij| <= drop_tolerance .
+    //    ,   ,
+    //    
+    explicit TCSRMatrix(const TDynamicMatrix<T>& m, T drop_tolerance = T(0))
+        : TCSRMatrix(int(m.size()), int(m.size())) {
+        int n = rows;
+        bool parallel = size_t(n) * n > CONVERT_PARALLEL_SIZE;
+#pragma omp parallel for schedule(static) if (parallel)
+        for (int i = 0; i < n; ++i) {
+            const T* a = m[i].data();
+            int count = 0;
+            for (int j = 0; j < n; ++j) {
+                if (abs(a[j]) > drop_tolerance) ++count;
+            }
+            row_index[i + 1] = count;
+        }
+        allocate_rows();
+#pragma omp parallel for schedule(static) if (parallel)
+        for (int i = 0; i < n; ++i) {
+            const T* a = m[i].data();
+            int k = row_index[i];
+            for (int j = 0; j < n; ++j) {
+                if (abs(a[j]) > drop_tolerance) {
+                    col_indices[k] = j;
+                    values[k++] = a[j];
+                }
+            }
+        }
+    }
+    //  ;     
+    explicit TCSRMatrix(const TGeneralBandMatrix<T>& m) : TCSRMatrix(int(m.size()), int(m.size())) {
+        assign_band(m);
+    }
+    explicit TCSRMatrix(const TSymmetricBandMatrix<T>& m) : TCSRMatrix(int(m.size()), int(m.size())) {
+        assign_band(m);
+    }
+private:
+    //row_index[i + 1]     i: 
+    //         
+    void allocate_rows() {
+        row_index[0] = 0;
+        for (int i = 0; i < rows; ++i) row_index[i + 1] += row_index[i];
+        values.resize(row_index[rows]);
+        col_indices.resize(row_index[rows]);
+    }
+    template<class Band>
+    void assign_band(const Band& m) {
+        int n = rows, lbw = m.lower_band(), ubw = m.upper_band();
+        bool parallel = size_t(n) * (lbw + ubw + 1) > CONVERT_PARALLEL_SIZE;
+#pragma omp parallel for schedule(static) if (parallel)
+        for (int i = 0; i < n; ++i) {
+            int count = 0;
+            for (int offset = max(-lbw, -i); offset <= min(ubw, n - 1 - i); ++offset) {
+                if (m.band_value(i, offset) != T(0)) ++count;
+            }
+            row_index[i + 1] = count;
+        }
+        allocate_rows();
+#pragma omp parallel for schedule(static) if (parallel)
+        for (int i = 0; i < n; ++i) {
+            int k = row_index[i];
+            for (int offset = max(-lbw, -i); offset <= min(ubw, n - 1 - i); ++offset) {
+                T v = m.band_value(i, offset);
+                if (v != T(0)) {
+                    col_indices[k] = i + offset;
+                    values[k++] = v;
+                }
+            }
+        }
+    }
+public:
     void set(int i, int j, T val) {
         if (i < 0 || i >= rows || j < 0 || j >= cols) {
             throw ("invalid index");
         }
+        TMATRIX_OP(CSRSet, 0, 0, 0);
         if (val == T(0)) {
             //     -  
             int start = row_index[i];
@@ -361,52 +676,271 @@ public:
     T operator()(int i, int j) const {
         return get(i, j);
     }
-    //
+    //  , y = A * x; x -   cols, y -  rows.
+    //     Acc  y:     float,
+    //   double
+    template<typename Acc>
+    void multiply(const T* x, Acc* y) const {
+        TMATRIX_OP(CSRVector, 2 * values.size(), values.size() * (2 * sizeof(T) + sizeof(int)) + (rows + 1) * sizeof(int),
+                   rows * sizeof(Acc));
+#pragma omp parallel for schedule(static) if (values.size() >= CSR_SPMV_PARALLEL_SIZE)
+        for (int i = 0; i < rows; ++i) {
+            Acc sum = Acc(0);
+            for (int k = row_index[i]; k < row_index[i + 1]; ++k) {
+                sum += Acc(values[k]) * Acc(x[col_indices[k]]);
+            }
+            y[i] = sum;
+        }
+    }
+    template<typename Acc>
+    TDynamicVector<Acc> multiply(const TDynamicVector<T>& v) const {
+        if ((size_t)cols != v.size()) {
+            throw invalid_argument("all sizes don't match");
+        }
+        TDynamicVector<Acc> result(rows);
+        multiply(v.data(), result.data());
+        return result;
+    }
+    TDynamicVector<T> operator*(const TDynamicVector<T>& v) const {
+        return multiply<T>(v);
+    }
+    //       A^T:
+    //  A      x[i]
+    friend TDynamicVector<T> operator*(const TTransposed<TCSRMatrix>& at, const TDynamicVector<T>& v) {
+        const TCSRMatrix& m = at.m;
+        if ((size_t)m.rows != v.size()) {
+            throw invalid_argument("all sizes don't match");
+        }
+        TMATRIX_OP(CSRVector, 2 * m.values.size(),
+                   m.values.size() * (2 * sizeof(T) + sizeof(int)) + (m.rows + 1) * sizeof(int), m.cols * sizeof(T));
+        TDynamicVector<T> result(m.cols);
+        T* y = result.data();
+        const T* x = v.data();
+        for (int i = 0; i < m.rows; ++i) {
+            const T xi = x[i];
+            for (int k = m.row_index[i]; k < m.row_index[i + 1]; ++k) {
+                y[m.col_indices[k]] += m.values[k] * xi;
+            }
+        }
+        return result;
+    }
+    //     ( ).
+    //   ,    
+    //.      
+    //  ,     ,  
+    //           .
+    //   ,     .
+    //,   ,    
     TCSRMatrix<T> operator*(const TCSRMatrix<T>& m) const {
         if (cols != m.rows) {
             throw ("matrix dimensions don't match for multiplication");
         }
-        TCSRMatrix<T> result(rows, m.cols);
-        for (int i = 0; i < rows; ++i) {
-            vector<T> row_result(m.cols, T(0));
-            //   i   
-            int start_i = row_index[i];
-            int end_i = row_index[i + 1];
-            for (int k_idx = start_i; k_idx < end_i; ++k_idx) {
-                int k = col_indices[k_idx];
-                T val_ik = values[k_idx];
-                //    k   
-                int start_k = m.row_index[k];
-                int end_k = m.row_index[k + 1];
-                for (int j_idx = start_k; j_idx < end_k; ++j_idx) {
-                    int j = m.col_indices[j_idx];
-                    row_result[j] += val_ik * m.values[j_idx];
+        TMATRIX_OP(CSRMultiply, spgemm_flops(m), memory_arrays() + m.memory_arrays(), 0);
+        const bool parallel = values.size() + m.values.size() > SPGEMM_PARALLEL_SIZE;
+        TTrackedVector<int> ptr(size_t(rows) + 1, 0);
+#pragma omp parallel if (parallel)
+        {
+            vector<int> mark(m.cols, -1);
+#pragma omp for schedule(dynamic, SPGEMM_ROW_CHUNK)
+            for (int i = 0; i < rows; ++i) {
+                int count = 0;
+                for (int p = row_index[i]; p < row_index[i + 1]; ++p) {
+                    int k = col_indices[p];
+                    for (int q = m.row_index[k]; q < m.row_index[k + 1]; ++q) {
+                        int j = m.col_indices[q];
+                        if (mark[j] != i) {
+                            mark[j] = i;
+                            ++count;
+                        }
+                    }
                 }
+                ptr[i + 1] = count;
             }
-            //    
-            for (int j = 0; j < m.cols; ++j) {
-                if (row_result[j] != T(0)) {
-                    result.set(i, j, row_result[j]);
+        }
+        prefix_sum(ptr.data() + 1, rows);
+        TTrackedVector<int> col(ptr[rows]);
+        TTrackedVector<T> val(ptr[rows]);
+        //kept[i] -    i,   
+        vector<int> kept(rows);
+#pragma omp parallel if (parallel)
+        {
+            vector<T> acc(m.cols);
+            vector<int> mark(m.cols, -1);
+#pragma omp for schedule(dynamic, SPGEMM_ROW_CHUNK)
+            for (int i = 0; i < rows; ++i) {
+                int* c = col.data() + ptr[i];
+                T* v = val.data() + ptr[i];
+                int len = 0;
+                for (int p = row_index[i]; p < row_index[i + 1]; ++p) {
+                    int k = col_indices[p];
+                    const T a_ik = values[p];
+                    for (int q = m.row_index[k]; q < m.row_index[k + 1]; ++q) {
+                        int j = m.col_indices[q];
+                        if (mark[j] != i) {
+                            mark[j] = i;
+                            c[len++] = j;
+                            acc[j] = a_ik * m.values[q];
+                        }
+                        else {
+                            acc[j] += a_ik * m.values[q];
+                        }
+                    }
                 }
+                sort(c, c + len);
+                int w = 0;
+                for (int t = 0; t < len; ++t) {
+                    if (acc[c[t]] != T(0)) {
+                        c[w] = c[t];
+                        v[w++] = acc[c[t]];
+                    }
+                }
+                kept[i] = w;
+            }
+        }
+        if (accumulate(kept.begin(), kept.end(), size_t(0)) != col.size()) {
+            // :     
+            TTrackedVector<int> packed_ptr(size_t(rows) + 1, 0);
+            copy(kept.begin(), kept.end(), packed_ptr.begin() + 1);
+            prefix_sum(packed_ptr.data() + 1, rows);
+            TTrackedVector<int> packed_col(packed_ptr[rows]);
+            TTrackedVector<T> packed_val(packed_ptr[rows]);
+#pragma omp parallel for schedule(static) if (parallel)
+            for (int i = 0; i < rows; ++i) {
+                copy_n(col.begin() + ptr[i], kept[i], packed_col.begin() + packed_ptr[i]);
+                copy_n(val.begin() + ptr[i], kept[i], packed_val.begin() + packed_ptr[i]);
             }
+            ptr = move(packed_ptr);
+            col = move(packed_col);
+            val = move(packed_val);
         }
+        TCSRMatrix<T> result(rows, m.cols, move(ptr), move(col), move(val));
+        TMATRIX_OP_ADD(0, 0, result.memory_arrays());
         return result;
     }
     //
-    friend ostream& operator<<(ostream& ostr, const TCSRMatrix& m) {
-        ostr << "CSR Matrix " << m.rows << "x" << m.cols << " ( : " << m.values.size() << "):" << endl;
-        //   
-        ostr << " :" << endl;
-        for (int i = 0; i < m.rows; ++i) {
-            for (int j = 0; j < m.cols; ++j) {
-                ostr << m.get(i, j) << " ";
+    //Coordinates -  "  ", Arrays -  CSR  ,
+    //Dense -  ;   O(rows * cols),  
+    //     dense_limit 
+    void print(ostream& ostr, TCSROutput mode = TCSROutput::Coordinates,
+               size_t dense_limit = CSR_DENSE_PRINT_LIMIT) const {
+        switch (mode) {
+        case TCSROutput::Coordinates:
+            for (int i = 0; i < rows; ++i) {
+                for (int k = row_index[i]; k < row_index[i + 1]; ++k) {
+                    ostr << i << ' ' << col_indices[k] << ' ' << values[k] << '\n';
+                }
             }
-            ostr << endl;
+            break;
+        case TCSROutput::Arrays:
+            ostr << "row_index:";
+            for (int k : row_index) ostr << ' ' << k;
+            ostr << "\ncol_indices:";
+            for (int k : col_indices) ostr << ' ' << k;
+            ostr << "\nvalues:";
+            for (const T& v : values) ostr << ' ' << v;
+            ostr << '\n';
+            break;
+        case TCSROutput::Dense: {
+            if ((size_t)rows * (size_t)cols > dense_limit) {
+                throw out_of_range("matrix is too large for dense output");
+            }
+            //     O(cols + nnz )
+            vector<T> row(cols, T(0));
+            for (int i = 0; i < rows; ++i) {
+                for (int k = row_index[i]; k < row_index[i + 1]; ++k) row[col_indices[k]] = values[k];
+                for (int j = 0; j < cols; ++j) ostr << row[j] << " ";
+                ostr << '\n';
+                for (int k = row_index[i]; k < row_index[i + 1]; ++k) row[col_indices[k]] = T(0);
+            }
+            break;
+        }
         }
+    }
+    friend ostream& operator<<(ostream& ostr, const TCSRMatrix& m) {
+        ostr << "CSR Matrix " << m.rows << "x" << m.cols << " ( : " << m.values.size() << "):" << endl;
+        //  ;   -   print(..., TCSROutput::Dense)
+        ostr << "  (  ):" << endl;
+        m.print(ostr, TCSROutput::Coordinates);
         return ostr;
     }
     int get_rows() const { return rows; }
     int get_cols() const { return cols; }
     int non_zeros() const { return values.size(); }
+    // CSR  ,    ;
+    //      
+    const int* row_index_data() const { return row_index.data(); }
+    const int* col_indices_data() const { return col_indices.data(); }
+    const T* values_data() const { return values.data(); }
+    // ;    
+    TDynamicMatrix<T> to_dense() const {
+        if (rows != cols) {
+            throw invalid_argument("dense matrix must be square");
+        }
+        TDynamicMatrix<T> result(rows);
+        vector<T*> dst(rows);
+        for (int i = 0; i < rows; ++i) dst[i] = result[i].data();
+#pragma omp parallel for schedule(static) if (size_t(rows) * rows > CONVERT_PARALLEL_SIZE)
+        for (int i = 0; i < rows; ++i) {
+            for (int k = row_index[i]; k < row_index[i + 1]; ++k) dst[i][col_indices[k]] = values[k];
+        }
+        return result;
+    }
+    //     -    
+    //  .        
+    //    : reduction(max)  OpenMP 3.1,
+    // MSVC   OpenMP 2.0
+    void band_widths(int& lower, int& upper) const {
+        lower = 0;
+        upper = 0;
+#pragma omp parallel if (values.size() + rows > CONVERT_PARALLEL_SIZE)
+        {
+            int lo = 0, up = 0;
+#pragma omp for schedule(static)
+            for (int i = 0; i < rows; ++i) {
+                for (int k = row_index[i]; k < row_index[i + 1]; ++k) {
+                    lo = max(lo, i - col_indices[k]);
+                    up = max(up, col_indices[k] - i);
+                }
+            }
+#pragma omp critical
+            {
+                lower = max(lower, lo);
+                upper = max(upper, up);
+            }
+        }
+    }
+    //     band_widths.   
+    //  ,     - O(nnz + n *  )
+    TGeneralBandMatrix<T> to_band() const {
+        if (rows != cols) {
+            throw invalid_argument("band matrix must be square");
+        }
+        int lbw, ubw;
+        band_widths(lbw, ubw);
+        bool parallel = values.size() + rows > CONVERT_PARALLEL_SIZE;
+        TGeneralBandMatrix<T> result(typename TGeneralBandMatrix<T>::TBandOnly(), rows, lbw, ubw);
+        vector<T*> diag(lbw + ubw + 1);
+        for (int offset = -lbw; offset <= ubw; ++offset) diag[lbw + offset] = result.diagonal_data(offset);
+#pragma omp parallel for schedule(static) if (parallel)
+        for (int i = 0; i < rows; ++i) {
+            for (int k = row_index[i]; k < row_index[i + 1]; ++k) {
+                int offset = col_indices[k] - i;
+                diag[lbw + offset][offset > 0 ? i : col_indices[k]] = values[k];
+            }
+        }
+        return result;
+    }
+    //   .     ,
+    //    set     
+    size_t memory_bytes() const {
+        return sizeof(*this) + heap_block_bytes(values.capacity() * sizeof(T), alignof(T))
+            + heap_block_bytes(col_indices.capacity() * sizeof(int), alignof(int))
+            + heap_block_bytes(row_index.capacity() * sizeof(int), alignof(int));
+    }
+    //     
+    void shrink_to_fit() {
+        values.shrink_to_fit();
+        col_indices.shrink_to_fit();
+    }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,213 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Счетчики операций и выделений памяти.
+// Включаются определением макроса TMATRIX_INSTRUMENT до подключения
+// заголовков библиотеки; без него макросы TMATRIX_OP и TMATRIX_ALLOC
+// раскрываются в пустые выражения и их аргументы не вычисляются.
+// TMATRIX_OP(op, flops, bytes_read, bytes_written) учитывает операцию до конца
+// блока, TMATRIX_OP_ADD добавляет к ней объемы, известные только в конце.
+//
+// Ограничения:
+// - текущая операция хранится отдельно для каждого потока, поэтому
+//   выделения памяти рабочими потоками OpenMP внутри параллельных участков
+//   (накопители SpGEMM, отметки BSR и т.п.) учитываются как Other; flops,
+//   объемы и время операции учитываются полностью потоком, который ее начал;
+// - учитываются только операции TDynamicVector, TDynamicMatrix, ленточных
+//   и CSR-матриц из перечисления TMatrixOp. Умножение Штрассена, LU-разложение,
+//   пакетные операции, представления (views) и итерационные методы своих
+//   счетчиков не имеют: вызванные ими операции из TMatrixOp учитываются
+//   как самостоятельные, а прочие выделения памяти - как Other
+
+#ifndef __INSTRUMENT_H__
+#define __INSTRUMENT_H__
+
+#ifdef TMATRIX_INSTRUMENT
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+// Типы учитываемых операций
+enum class TMatrixOp
+{
+  VectorScalar,     // вектор и число
+  VectorAdd,        // сложение и вычитание векторов
+  VectorDot,        // скалярное произведение
+  MatrixScalar,     // плотная матрица и число
+  MatrixVector,     // плотная матрица на вектор
+  MatrixAdd,        // сложение и вычитание плотных матриц
+  MatrixMultiply,   // произведение плотных матриц
+  MatrixTranspose,  // транспонирование
+  BandVector,       // ленточная матрица на вектор
+  BandMultiply,     // произведение ленточных матриц
+  CSRVector,        // CSR на вектор
+  CSRMultiply,      // произведение CSR-матриц
+  CSRSet,           // запись элемента CSR
+  Other,            // выделения памяти вне учитываемых операций
+  Count
+};
+
+inline const char* instrument_op_name(TMatrixOp op)
+{
+  static const char* const names[] = {
+    "vector_scalar", "vector_add", "vector_dot",
+    "matrix_scalar", "matrix_vector", "matrix_add", "matrix_multiply", "matrix_transpose",
+    "band_vector", "band_multiply",
+    "csr_vector", "csr_multiply", "csr_set",
+    "other"
+  };
+  return names[size_t(op)];
+}
+
+// Значения счетчиков одного типа операций
+struct TOpCounters
+{
+  uint64_t calls = 0;
+  uint64_t flops = 0;             // арифметические операции по формуле для размеров операндов
+  uint64_t bytes_read = 0;        // объем прочитанных операндов
+  uint64_t bytes_written = 0;     // объем записанного результата
+  uint64_t allocations = 0;       // выделения памяти во время операции
+  uint64_t bytes_allocated = 0;
+  double seconds = 0.0;
+};
+
+struct TOpAccumulator
+{
+  atomic<uint64_t> calls{ 0 }, flops{ 0 }, bytes_read{ 0 }, bytes_written{ 0 };
+  atomic<uint64_t> allocations{ 0 }, bytes_allocated{ 0 }, nanoseconds{ 0 };
+};
+
+inline TOpAccumulator& instrument_slot(TMatrixOp op)
+{
+  static TOpAccumulator table[size_t(TMatrixOp::Count)];
+  return table[size_t(op)];
+}
+
+// операция, выполняемая текущим потоком; у рабочих потоков параллельных
+// участков она не наследуется и остается Other
+inline TMatrixOp& instrument_current_op()
+{
+  thread_local TMatrixOp op = TMatrixOp::Other;
+  return op;
+}
+
+inline void instrument_alloc(size_t bytes)
+{
+  TOpAccumulator& a = instrument_slot(instrument_current_op());
+  a.allocations.fetch_add(1, memory_order_relaxed);
+  a.bytes_allocated.fetch_add(bytes, memory_order_relaxed);
+}
+
+// Учет одной операции от создания до уничтожения объекта.
+// Операции, вызванные внутри другой (строки матрицы внутри матричной
+// операции), отдельно не учитываются: их работа и выделения памяти
+// относятся к внешней операции
+class TOpScope
+{
+  TMatrixOp op;
+  bool outer;
+  chrono::steady_clock::time_point start;
+public:
+  TOpScope(TMatrixOp o, uint64_t flops, uint64_t bytes_read, uint64_t bytes_written)
+    : op(o), outer(instrument_current_op() == TMatrixOp::Other)
+  {
+    if (!outer)
+      return;
+    TOpAccumulator& a = instrument_slot(op);
+    a.calls.fetch_add(1, memory_order_relaxed);
+    a.flops.fetch_add(flops, memory_order_relaxed);
+    a.bytes_read.fetch_add(bytes_read, memory_order_relaxed);
+    a.bytes_written.fetch_add(bytes_written, memory_order_relaxed);
+    instrument_current_op() = op;
+    start = chrono::steady_clock::now();
+  }
+  // дополнительные объемы, известные только после выполнения операции
+  void add(uint64_t flops, uint64_t bytes_read, uint64_t bytes_written)
+  {
+    if (!outer)
+      return;
+    TOpAccumulator& a = instrument_slot(op);
+    a.flops.fetch_add(flops, memory_order_relaxed);
+    a.bytes_read.fetch_add(bytes_read, memory_order_relaxed);
+    a.bytes_written.fetch_add(bytes_written, memory_order_relaxed);
+  }
+  TOpScope(const TOpScope&) = delete;
+  TOpScope& operator=(const TOpScope&) = delete;
+  ~TOpScope()
+  {
+    if (!outer)
+      return;
+    auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    instrument_slot(op).nanoseconds.fetch_add(uint64_t(ns), memory_order_relaxed);
+    instrument_current_op() = TMatrixOp::Other;
+  }
+};
+
+inline TOpCounters instrument_counters(TMatrixOp op)
+{
+  const TOpAccumulator& a = instrument_slot(op);
+  TOpCounters c;
+  c.calls = a.calls.load(memory_order_relaxed);
+  c.flops = a.flops.load(memory_order_relaxed);
+  c.bytes_read = a.bytes_read.load(memory_order_relaxed);
+  c.bytes_written = a.bytes_written.load(memory_order_relaxed);
+  c.allocations = a.allocations.load(memory_order_relaxed);
+  c.bytes_allocated = a.bytes_allocated.load(memory_order_relaxed);
+  c.seconds = double(a.nanoseconds.load(memory_order_relaxed)) * 1e-9;
+  return c;
+}
+
+inline void instrument_reset()
+{
+  for (size_t i = 0; i < size_t(TMatrixOp::Count); i++) {
+    TOpAccumulator& a = instrument_slot(TMatrixOp(i));
+    a.calls = 0;
+    a.flops = 0;
+    a.bytes_read = 0;
+    a.bytes_written = 0;
+    a.allocations = 0;
+    a.bytes_allocated = 0;
+    a.nanoseconds = 0;
+  }
+}
+
+// Таблица по всем операциям, которые выполнялись или выделяли память
+inline void instrument_report(ostream& ostr)
+{
+  ios_base::fmtflags flags = ostr.flags();
+  streamsize precision = ostr.precision();
+  ostr << left << setw(18) << "operation" << right << setw(12) << "calls" << setw(16) << "flops"
+       << setw(16) << "bytes read" << setw(16) << "bytes written" << setw(12) << "allocs"
+       << setw(16) << "bytes alloc" << setw(14) << "seconds" << '\n';
+  for (size_t i = 0; i < size_t(TMatrixOp::Count); i++) {
+    TOpCounters c = instrument_counters(TMatrixOp(i));
+    if (c.calls == 0 && c.allocations == 0)
+      continue;
+    ostr << left << setw(18) << instrument_op_name(TMatrixOp(i)) << right << setw(12) << c.calls
+         << setw(16) << c.flops << setw(16) << c.bytes_read << setw(16) << c.bytes_written
+         << setw(12) << c.allocations << setw(16) << c.bytes_allocated
+         << setw(14) << fixed << setprecision(6) << c.seconds << '\n';
+  }
+  ostr.flags(flags);
+  ostr.precision(precision);
+}
+
+#define TMATRIX_OP(op, flops, bytes_read, bytes_written) \
+  TOpScope tmatrix_op_scope(TMatrixOp::op, uint64_t(flops), uint64_t(bytes_read), uint64_t(bytes_written))
+#define TMATRIX_OP_ADD(flops, bytes_read, bytes_written) \
+  tmatrix_op_scope.add(uint64_t(flops), uint64_t(bytes_read), uint64_t(bytes_written))
+#define TMATRIX_ALLOC(bytes) instrument_alloc(bytes)
+
+#else
+
+#define TMATRIX_OP(op, flops, bytes_read, bytes_written) ((void)0)
+#define TMATRIX_OP_ADD(flops, bytes_read, bytes_written) ((void)0)
+#define TMATRIX_ALLOC(bytes) ((void)0)
+
+#endif
+
+#endif
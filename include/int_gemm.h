@@ -0,0 +1,277 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Умножение матриц из узких целых (int8, uint8, int16) с накоплением в int32
+
+#ifndef __INT_GEMM_H__
+#define __INT_GEMM_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Набор команд ядра выбирается при компиляции:
+//  - AVX-512 VNNI: vpdpbusd складывает четверки произведений u8 * s8,
+//    vpdpwssd - пары произведений int16, сразу прибавляя их к int32;
+//  - AVX2: vpmaddwd складывает пары произведений int16 в int32, с AVX-VNNI
+//    доступны и 256-битные vpdpbusd и vpdpwssd;
+//  - без них работает переносимый цикл.
+// vpmaddubsw не используется: он насыщает сумму пары u8 * s8 в int16
+// (255 * 127 * 2 > 32767) и без ограничений на значения дает неверный ответ
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+#define INT_GEMM_AVX512VNNI
+#elif defined(__AVX2__)
+#define INT_GEMM_AVX2
+#endif
+
+#if defined(INT_GEMM_AVX512VNNI)
+typedef __m512i int_gemm_vec;
+const size_t INT_GEMM_LANES = 16;
+const bool INT_GEMM_DOT8 = true;
+inline int_gemm_vec int_gemm_zero() { return _mm512_setzero_si512(); }
+inline int_gemm_vec int_gemm_load(const int32_t* p) { return _mm512_loadu_si512(p); }
+inline int_gemm_vec int_gemm_broadcast(int32_t w) { return _mm512_set1_epi32(w); }
+inline void int_gemm_store(int32_t* p, int_gemm_vec v) { _mm512_storeu_si512(p, v); }
+inline int_gemm_vec int_gemm_dot16(int_gemm_vec acc, int_gemm_vec a, int_gemm_vec b)
+{
+  return _mm512_dpwssd_epi32(acc, a, b);
+}
+inline int_gemm_vec int_gemm_dot8(int_gemm_vec acc, int_gemm_vec u, int_gemm_vec s)
+{
+  return _mm512_dpbusd_epi32(acc, u, s);
+}
+#elif defined(INT_GEMM_AVX2)
+typedef __m256i int_gemm_vec;
+const size_t INT_GEMM_LANES = 8;
+inline int_gemm_vec int_gemm_zero() { return _mm256_setzero_si256(); }
+inline int_gemm_vec int_gemm_load(const int32_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+inline int_gemm_vec int_gemm_broadcast(int32_t w) { return _mm256_set1_epi32(w); }
+inline void int_gemm_store(int32_t* p, int_gemm_vec v) { _mm256_storeu_si256((__m256i*)p, v); }
+#if defined(__AVXVNNI__)
+const bool INT_GEMM_DOT8 = true;
+inline int_gemm_vec int_gemm_dot16(int_gemm_vec acc, int_gemm_vec a, int_gemm_vec b)
+{
+  return _mm256_dpwssd_avx_epi32(acc, a, b);
+}
+inline int_gemm_vec int_gemm_dot8(int_gemm_vec acc, int_gemm_vec u, int_gemm_vec s)
+{
+  return _mm256_dpbusd_avx_epi32(acc, u, s);
+}
+#else
+const bool INT_GEMM_DOT8 = false;
+inline int_gemm_vec int_gemm_dot16(int_gemm_vec acc, int_gemm_vec a, int_gemm_vec b)
+{
+  return _mm256_add_epi32(acc, _mm256_madd_epi16(a, b));
+}
+inline int_gemm_vec int_gemm_dot8(int_gemm_vec acc, int_gemm_vec, int_gemm_vec) { return acc; }
+#endif
+#else
+const bool INT_GEMM_DOT8 = false;
+#endif
+
+#if defined(INT_GEMM_AVX512VNNI) || defined(INT_GEMM_AVX2)
+const bool INT_GEMM_SIMD = true;
+#else
+const bool INT_GEMM_SIMD = false;
+#endif
+
+// Блок ядра: INT_GEMM_ROWS строк A на INT_GEMM_VECS векторов столбцов B.
+// Отрезок по k длиной INT_GEMM_BLOCK_K (кратен 4) упаковывается целиком
+const size_t INT_GEMM_ROWS = 4;
+const size_t INT_GEMM_VECS = 2;
+const size_t INT_GEMM_BLOCK_K = 256;
+// Число умножений m * n * p, начиная с которого полосы столбцов
+// считаются параллельно
+const size_t INT_GEMM_PARALLEL_SIZE = 1 << 21;
+
+// Узкие целые типы, для которых есть ядро
+template<typename T>
+struct is_narrow_int
+  : integral_constant<bool, is_same<T, int8_t>::value || is_same<T, uint8_t>::value || is_same<T, int16_t>::value>
+{
+};
+
+// Упаковка пары A, B для ядра. В 32-битное слово кладутся group соседних
+// по k значений: две половины int16 или четыре байта. Четверки байт
+// складывает vpdpbusd, у которого первый сомножитель без знака, второй со
+// знаком: при B без знака сомножители меняются местами, а если оба со
+// знаком, к A прибавляется 128 и из результата вычитается 128 * сумма
+// столбца B
+template<typename TA, typename TB>
+struct TIntGemmFormat
+{
+  static_assert(is_narrow_int<TA>::value && is_narrow_int<TB>::value, "int8, uint8 or int16 expected");
+
+  static constexpr bool dot8 = INT_GEMM_DOT8 && sizeof(TA) == 1 && sizeof(TB) == 1
+                               && !(is_unsigned<TA>::value && is_unsigned<TB>::value);
+  static constexpr size_t group = dot8 ? 4 : 2;
+  static constexpr bool swap = dot8 && is_unsigned<TB>::value;
+  static constexpr int32_t shift_a = dot8 && is_signed<TA>::value && is_signed<TB>::value ? 128 : 0;
+
+  // значение v с номером l внутри слова
+  static uint32_t lane(int32_t v, size_t l)
+  {
+    return group == 2 ? (uint32_t(v) & 0xFFFFu) << (16 * l) : (uint32_t(v) & 0xFFu) << (8 * l);
+  }
+};
+
+#if defined(INT_GEMM_AVX512VNNI) || defined(INT_GEMM_AVX2)
+// Блок out[ROWS][VECS * LANES] = сумма по kg словам: a - упакованные строки
+// A по kg слов, b - упакованная полоса B, kg слов на каждый столбец
+template<class F>
+inline void int_gemm_kernel(const int32_t* a, const int32_t* b, size_t kg,
+                            int32_t (&out)[INT_GEMM_ROWS][INT_GEMM_VECS * INT_GEMM_LANES])
+{
+  const size_t nr = INT_GEMM_VECS * INT_GEMM_LANES;
+  int_gemm_vec acc[INT_GEMM_ROWS][INT_GEMM_VECS];
+  for (size_t r = 0; r < INT_GEMM_ROWS; r++)
+    for (size_t v = 0; v < INT_GEMM_VECS; v++)
+      acc[r][v] = int_gemm_zero();
+  for (size_t g = 0; g < kg; g++) {
+    int_gemm_vec bv[INT_GEMM_VECS];
+    for (size_t v = 0; v < INT_GEMM_VECS; v++)
+      bv[v] = int_gemm_load(b + g * nr + v * INT_GEMM_LANES);
+    for (size_t r = 0; r < INT_GEMM_ROWS; r++) {
+      const int_gemm_vec av = int_gemm_broadcast(a[r * kg + g]);
+      for (size_t v = 0; v < INT_GEMM_VECS; v++) {
+        if (!F::dot8)
+          acc[r][v] = int_gemm_dot16(acc[r][v], av, bv[v]);
+        else if (F::swap)
+          acc[r][v] = int_gemm_dot8(acc[r][v], bv[v], av);
+        else
+          acc[r][v] = int_gemm_dot8(acc[r][v], av, bv[v]);
+      }
+    }
+  }
+  for (size_t r = 0; r < INT_GEMM_ROWS; r++)
+    for (size_t v = 0; v < INT_GEMM_VECS; v++)
+      int_gemm_store(out[r] + v * INT_GEMM_LANES, acc[r][v]);
+}
+#endif
+
+// C += A * B, где A - m x p из TA, B - p x n из TB, C - int32.
+// Строки задаются функциями a(i), b(k), c(i), как в gemm_blocked; элементы
+// строк могут быть и шире TA, TB (например, int), но их значения должны
+// в них умещаться. Отрезок по k упаковывается: A - по строкам, B - полосами
+// по VECS * LANES столбцов, недостающие строки и столбцы заполняются нулями.
+// Полоса B (kg * VECS * LANES слов) остается в кэше L1, пока по ней проходят
+// все блоки строк A. Переполнение int32 не проверяется
+template<typename TA, typename TB, typename RowA, typename RowB, typename RowC>
+void gemm_int(size_t m, size_t n, size_t p, RowA a, RowB b, RowC c)
+{
+#if defined(INT_GEMM_AVX512VNNI) || defined(INT_GEMM_AVX2)
+  typedef TIntGemmFormat<TA, TB> F;
+  const size_t G = F::group, MR = INT_GEMM_ROWS, NR = INT_GEMM_VECS * INT_GEMM_LANES;
+  const size_t mb = (m + MR - 1) / MR, panels = (n + NR - 1) / NR;
+  vector<int32_t> ap, bp, colsum;
+  for (size_t kk = 0; kk < p; kk += INT_GEMM_BLOCK_K) {
+    const size_t kend = min(kk + INT_GEMM_BLOCK_K, p), kg = (kend - kk + G - 1) / G;
+    ap.assign(mb * MR * kg, 0);
+    for (size_t i = 0; i < m; i++) {
+      const auto* ai = a(i);
+      uint32_t* w = reinterpret_cast<uint32_t*>(ap.data() + i * kg);
+      for (size_t k = kk; k < kend; k++)
+        w[(k - kk) / G] |= F::lane(int32_t(TA(ai[k])) + F::shift_a, (k - kk) % G);
+    }
+    bp.assign(panels * kg * NR, 0);
+    if (F::shift_a)
+      colsum.assign(n, 0);
+    for (size_t k = kk; k < kend; k++) {
+      const auto* bk = b(k);
+      const size_t g = (k - kk) / G, l = (k - kk) % G;
+      for (size_t j = 0; j < n; j++) {
+        int32_t v = int32_t(TB(bk[j]));
+        reinterpret_cast<uint32_t&>(bp[((j / NR) * kg + g) * NR + j % NR]) |= F::lane(v, l);
+        if (F::shift_a)
+          colsum[j] += v;
+      }
+    }
+#pragma omp parallel for schedule(static) if (m * n * p > INT_GEMM_PARALLEL_SIZE)
+    for (long long t = 0; t < (long long)panels; t++) {
+      const size_t j0 = size_t(t) * NR, jn = min(NR, n - j0);
+      int32_t out[INT_GEMM_ROWS][INT_GEMM_VECS * INT_GEMM_LANES];
+      for (size_t ib = 0; ib < mb; ib++) {
+        int_gemm_kernel<F>(ap.data() + ib * MR * kg, bp.data() + size_t(t) * kg * NR, kg, out);
+        for (size_t r = 0; r < MR && ib * MR + r < m; r++) {
+          int32_t* ci = c(ib * MR + r) + j0;
+          for (size_t j = 0; j < jn; j++)
+            ci[j] += out[r][j] - (F::shift_a ? F::shift_a * colsum[j0 + j] : 0);
+        }
+      }
+    }
+  }
+#else
+  for (size_t kk = 0; kk < p; kk += INT_GEMM_BLOCK_K) {
+    const size_t kend = min(kk + INT_GEMM_BLOCK_K, p);
+    for (size_t i = 0; i < m; i++) {
+      int32_t* ci = c(i);
+      const auto* ai = a(i);
+      for (size_t k = kk; k < kend; k++) {
+        const int32_t aik = TA(ai[k]);
+        const auto* bk = b(k);
+        for (size_t j = 0; j < n; j++)
+          ci[j] += aik * int32_t(TB(bk[j]));
+      }
+    }
+  }
+#endif
+}
+
+// Диапазон значений матрицы rows x cols со строками r(i)
+struct TIntRange
+{
+  long long lo, hi;
+
+  bool fits_int8() const noexcept { return lo >= INT8_MIN && hi <= INT8_MAX; }
+  bool fits_uint8() const noexcept { return lo >= 0 && hi <= UINT8_MAX; }
+  bool fits_int16() const noexcept { return lo >= INT16_MIN && hi <= INT16_MAX; }
+};
+
+template<typename Row>
+TIntRange int_range(size_t rows, size_t cols, Row r)
+{
+  long long lo = 0, hi = 0;
+  for (size_t i = 0; i < rows; i++) {
+    const auto* ri = r(i);
+    for (size_t j = 0; j < cols; j++) {
+      lo = min(lo, (long long)ri[j]);
+      hi = max(hi, (long long)ri[j]);
+    }
+  }
+  return TIntRange{ lo, hi };
+}
+
+// C += A * B для целых матриц, значения которых умещаются в узкие типы:
+// выбирается ядро с самым узким подходящим форматом. Возвращает false,
+// если значения не помещаются в int16 и нужен обычный путь
+template<typename RowA, typename RowB, typename RowC>
+bool gemm_int_narrowed(size_t m, size_t n, size_t p, TIntRange ra, TIntRange rb, RowA a, RowB b, RowC c)
+{
+  if (INT_GEMM_DOT8) {
+    if (ra.fits_int8() && rb.fits_int8()) {
+      gemm_int<int8_t, int8_t>(m, n, p, a, b, c);
+      return true;
+    }
+    if (ra.fits_uint8() && rb.fits_int8()) {
+      gemm_int<uint8_t, int8_t>(m, n, p, a, b, c);
+      return true;
+    }
+    if (ra.fits_int8() && rb.fits_uint8()) {
+      gemm_int<int8_t, uint8_t>(m, n, p, a, b, c);
+      return true;
+    }
+  }
+  if (ra.fits_int16() && rb.fits_int16()) {
+    gemm_int<int16_t, int16_t>(m, n, p, a, b, c);
+    return true;
+  }
+  return false;
+}
+
+#endif
@@ -0,0 +1,293 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// LU-разложение плотных матриц, решение систем, определитель и обратная матрица
+
+#ifndef __LU_H__
+#define __LU_H__
+
+#include "tmatrix.h"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+// Ширина полосы столбцов, раскладываемой за один шаг блочного алгоритма
+const size_t LU_BLOCK = 64;
+// Порядок матрицы, начиная с которого обновления выполняются параллельно
+const size_t LU_PARALLEL_SIZE = 256;
+
+// C -= A * B, где A - m x p, B - p x n; строки задаются так же, как
+// в gemm_blocked. A с обратным знаком упаковывается в непрерывный буфер pack,
+// после чего C делится на прямоугольники GEMM_BLOCK_K x GEMM_BLOCK_N,
+// обновляемые параллельно
+template<typename T, typename RowA, typename RowB, typename RowC>
+void lu_gemm_sub(size_t m, size_t n, size_t p, RowA a, RowB b, RowC c, vector<T>& pack)
+{
+  if (m == 0 || n == 0 || p == 0)
+    return;
+  pack.resize(m * p);
+  for (size_t i = 0; i < m; i++) {
+    const T* ai = a(i);
+    T* d = pack.data() + i * p;
+    for (size_t k = 0; k < p; k++)
+      d[k] = -ai[k];
+  }
+  const T* pa = pack.data();
+  long long strips = (long long)((m + GEMM_BLOCK_K - 1) / GEMM_BLOCK_K);
+  long long chunks = (long long)((n + GEMM_BLOCK_N - 1) / GEMM_BLOCK_N);
+#pragma omp parallel for schedule(dynamic) if (m * n >= LU_PARALLEL_SIZE * LU_PARALLEL_SIZE)
+  for (long long t = 0; t < strips * chunks; t++) {
+    size_t i0 = size_t(t / chunks) * GEMM_BLOCK_K, i1 = min(m, i0 + GEMM_BLOCK_K);
+    size_t j0 = size_t(t % chunks) * GEMM_BLOCK_N, j1 = min(n, j0 + GEMM_BLOCK_N);
+    gemm_blocked<T>(i1 - i0, j1 - j0, p,
+        [pa, i0, p](size_t i) { return pa + (i0 + i) * p; },
+        [&b, j0](size_t k) { return b(k) + j0; },
+        [&c, i0, j0](size_t i) { return c(i0 + i) + j0; });
+  }
+}
+
+// Блочное LU-разложение с частичным выбором ведущего элемента (правосторонний
+// вариант): PA = LU. Множители L (без единичной диагонали) и U записываются
+// на место A, piv[k] - номер строки, переставленной с k-й на шаге k.
+// На каждом шаге раскладывается полоса из LU_BLOCK столбцов, затем решается
+// треугольная система для блока строк U и оставшаяся часть матрицы
+// обновляется одним умножением lu_gemm_sub, на которое приходится почти вся
+// работа. Строки переставляются обменом указателей, без копирования.
+// Возвращает false, если матрица вырождена; разложение при этом доводится
+// до конца, а нулевые ведущие элементы остаются на диагонали U
+template<typename T>
+bool lu_factor(TDynamicMatrix<T>& a, vector<size_t>& piv)
+{
+  size_t n = a.size();
+  piv.assign(n, 0);
+  vector<T*> r(n);
+  for (size_t i = 0; i < n; i++)
+    r[i] = a[i].data();
+  bool regular = true;
+  vector<T> pack;
+  for (size_t k0 = 0; k0 < n; k0 += LU_BLOCK) {
+    size_t k1 = min(n, k0 + LU_BLOCK);
+    // разложение полосы [k0, n) x [k0, k1)
+    for (size_t j = k0; j < k1; j++) {
+      size_t p = j;
+      T best = abs(r[j][j]);
+      for (size_t i = j + 1; i < n; i++)
+        if (abs(r[i][j]) > best) {
+          best = abs(r[i][j]);
+          p = i;
+        }
+      piv[j] = p;
+      if (p != j) {
+        std::swap(r[j], r[p]);
+        swap(a[j], a[p]);
+      }
+      if (r[j][j] == T()) {
+        regular = false;
+        continue;
+      }
+      const T inv = T(1) / r[j][j];
+      const T* rj = r[j];
+#pragma omp parallel for schedule(static) if (n - j >= LU_PARALLEL_SIZE)
+      for (long long i = (long long)j + 1; i < (long long)n; i++) {
+        T* ri = r[i];
+        const T l = ri[j] *= inv;
+        for (size_t c = j + 1; c < k1; c++)
+          ri[c] -= l * rj[c];
+      }
+    }
+    if (k1 == n)
+      break;
+    // U12 = L11^{-1} A12 по полосам столбцов
+    long long chunks = (long long)((n - k1 + GEMM_BLOCK_N - 1) / GEMM_BLOCK_N);
+#pragma omp parallel for schedule(static) if (n >= LU_PARALLEL_SIZE)
+    for (long long ch = 0; ch < chunks; ch++) {
+      size_t c0 = k1 + size_t(ch) * GEMM_BLOCK_N, c1 = min(n, c0 + GEMM_BLOCK_N);
+      for (size_t i = k0 + 1; i < k1; i++) {
+        T* ri = r[i];
+        for (size_t k = k0; k < i; k++) {
+          const T l = ri[k];
+          const T* rk = r[k];
+          for (size_t c = c0; c < c1; c++)
+            ri[c] -= l * rk[c];
+        }
+      }
+    }
+    // A22 -= L21 U12
+    lu_gemm_sub<T>(n - k1, n - k1, k1 - k0,
+        [&r, k1, k0](size_t i) { return (const T*)r[k1 + i] + k0; },
+        [&r, k0, k1](size_t k) { return (const T*)r[k0 + k] + k1; },
+        [&r, k1](size_t i) { return r[k1 + i] + k1; }, pack);
+  }
+  return regular;
+}
+
+// LU-разложение матрицы для многократного решения систем с ней
+template<typename T>
+class TLUDecomposition
+{
+  TDynamicMatrix<T> lu;
+  vector<size_t> piv;
+  bool regular;
+
+  void check_regular() const
+  {
+    if (!regular)
+      throw runtime_error("matrix is singular");
+  }
+
+  // X = L^{-1} X и X = U^{-1} X для m столбцов правых частей; x[i] - строка i.
+  // Внедиагональные блоки вычитаются через lu_gemm_sub, треугольники
+  // LU_BLOCK x LU_BLOCK - по полосам столбцов параллельно
+  void solve_rows(vector<T*>& x, size_t m) const
+  {
+    size_t n = lu.size();
+    vector<const T*> r(n);
+    for (size_t i = 0; i < n; i++)
+      r[i] = lu[i].data();
+    vector<T> pack;
+    long long chunks = (long long)((m + GEMM_BLOCK_N - 1) / GEMM_BLOCK_N);
+    for (size_t i0 = 0; i0 < n; i0 += LU_BLOCK) {
+      size_t i1 = min(n, i0 + LU_BLOCK);
+      lu_gemm_sub<T>(i1 - i0, m, i0,
+          [&r, i0](size_t i) { return r[i0 + i]; },
+          [&x](size_t k) { return (const T*)x[k]; },
+          [&x, i0](size_t i) { return x[i0 + i]; }, pack);
+#pragma omp parallel for schedule(static) if (m * n >= LU_PARALLEL_SIZE * LU_PARALLEL_SIZE)
+      for (long long ch = 0; ch < chunks; ch++) {
+        size_t c0 = size_t(ch) * GEMM_BLOCK_N, c1 = min(m, c0 + GEMM_BLOCK_N);
+        for (size_t i = i0 + 1; i < i1; i++)
+          for (size_t k = i0; k < i; k++) {
+            const T l = r[i][k];
+            for (size_t c = c0; c < c1; c++)
+              x[i][c] -= l * x[k][c];
+          }
+      }
+    }
+    for (size_t i1 = n; i1 > 0;) {
+      size_t i0 = i1 > LU_BLOCK ? i1 - LU_BLOCK : 0;
+      lu_gemm_sub<T>(i1 - i0, m, n - i1,
+          [&r, i0, i1](size_t i) { return r[i0 + i] + i1; },
+          [&x, i1](size_t k) { return (const T*)x[i1 + k]; },
+          [&x, i0](size_t i) { return x[i0 + i]; }, pack);
+#pragma omp parallel for schedule(static) if (m * n >= LU_PARALLEL_SIZE * LU_PARALLEL_SIZE)
+      for (long long ch = 0; ch < chunks; ch++) {
+        size_t c0 = size_t(ch) * GEMM_BLOCK_N, c1 = min(m, c0 + GEMM_BLOCK_N);
+        for (size_t i = i1; i-- > i0;) {
+          for (size_t k = i + 1; k < i1; k++) {
+            const T u = r[i][k];
+            for (size_t c = c0; c < c1; c++)
+              x[i][c] -= u * x[k][c];
+          }
+          const T inv = T(1) / r[i][i];
+          for (size_t c = c0; c < c1; c++)
+            x[i][c] *= inv;
+        }
+      }
+      i1 = i0;
+    }
+  }
+public:
+  explicit TLUDecomposition(const TDynamicMatrix<T>& a) : lu(a)
+  {
+    regular = lu_factor(lu, piv);
+  }
+
+  bool is_singular() const noexcept { return !regular; }
+  // L (без единичной диагонали) и U в одной матрице
+  const TDynamicMatrix<T>& factors() const noexcept { return lu; }
+  const vector<size_t>& pivots() const noexcept { return piv; }
+
+  T determinant() const
+  {
+    T det = T(1);
+    for (size_t i = 0; i < lu.size(); i++) {
+      det *= lu[i][i];
+      if (piv[i] != i)
+        det = -det;
+    }
+    return det;
+  }
+
+  // решение системы Ax = b
+  TDynamicVector<T> solve(const TDynamicVector<T>& b) const
+  {
+    size_t n = lu.size();
+    if (b.size() != n)
+      throw invalid_argument("all sizes don't match");
+    check_regular();
+    TDynamicVector<T> x(b);
+    T* px = x.data();
+    for (size_t k = 0; k < n; k++)
+      std::swap(px[k], px[piv[k]]);
+    for (size_t i = 1; i < n; i++) {
+      const T* ri = lu[i].data();
+      T sum = px[i];
+      for (size_t k = 0; k < i; k++)
+        sum -= ri[k] * px[k];
+      px[i] = sum;
+    }
+    for (size_t i = n; i-- > 0;) {
+      const T* ri = lu[i].data();
+      T sum = px[i];
+      for (size_t k = i + 1; k < n; k++)
+        sum -= ri[k] * px[k];
+      px[i] = sum / ri[i];
+    }
+    return x;
+  }
+
+  // решение системы AX = B со многими правыми частями
+  TDynamicMatrix<T> solve(const TDynamicMatrix<T>& b) const
+  {
+    size_t n = lu.size();
+    if (b.size() != n)
+      throw invalid_argument("all sizes don't match");
+    check_regular();
+    TDynamicMatrix<T> x(b);
+    for (size_t k = 0; k < n; k++)
+      if (piv[k] != k)
+        swap(x[k], x[piv[k]]);
+    vector<T*> rows(n);
+    for (size_t i = 0; i < n; i++)
+      rows[i] = x[i].data();
+    solve_rows(rows, n);
+    return x;
+  }
+
+  TDynamicMatrix<T> inverse() const
+  {
+    size_t n = lu.size();
+    TDynamicMatrix<T> e(n);
+    for (size_t i = 0; i < n; i++)
+      e[i][i] = T(1);
+    return solve(e);
+  }
+};
+
+template<typename T>
+T determinant(const TDynamicMatrix<T>& a)
+{
+  return TLUDecomposition<T>(a).determinant();
+}
+
+template<typename T>
+TDynamicVector<T> solve(const TDynamicMatrix<T>& a, const TDynamicVector<T>& b)
+{
+  return TLUDecomposition<T>(a).solve(b);
+}
+
+template<typename T>
+TDynamicMatrix<T> solve(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+{
+  return TLUDecomposition<T>(a).solve(b);
+}
+
+// Обратная матрица; для вырожденной матрицы бросает runtime_error
+template<typename T>
+TDynamicMatrix<T> inverse(const TDynamicMatrix<T>& a)
+{
+  return TLUDecomposition<T>(a).inverse();
+}
+
+#endif
@@ -0,0 +1,319 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Быстрый текстовый ввод/вывод векторов и матриц
+
+#ifndef __MATRIX_IO_H__
+#define __MATRIX_IO_H__
+
+#include "tmatrix.h"
+#include <charconv>
+#include <locale>
+#include <type_traits>
+#include <vector>
+
+// Объем текста, накапливаемого перед записью в поток
+const size_t WRITE_BUFFER_SIZE = 1 << 20;
+// Наибольший объем текста, забираемого из буфера потока за один раз
+const size_t READ_BUFFER_SIZE = 1 << 20;
+// Количество строк матрицы, форматируемых одной задачей при параллельной записи
+const size_t WRITE_ROW_BLOCK = 64;
+
+// Форматирование элементов через to_chars так же, как это делает ostream
+// с текущими флагами потока. Если флаги, ширина поля или локаль потока
+// требуют чего-то, чего to_chars не умеет, fast() возвращает false и
+// вывод следует выполнять обычным operator<<
+template<typename T>
+class TElementFormatter
+{
+  bool fast_path;
+  chars_format fmt;
+  int precision;
+public:
+  explicit TElementFormatter(const ostream& ostr) : fast_path(false), fmt(chars_format::general),
+                                                    precision(int(ostr.precision()))
+  {
+    const bool number = (is_integral<T>::value && !is_same<T, bool>::value && !is_same<T, char>::value &&
+                         !is_same<T, signed char>::value && !is_same<T, unsigned char>::value) ||
+                        is_floating_point<T>::value;
+    if (!number || ostr.width() != 0 || !(ostr.getloc() == locale::classic()))
+      return;
+    // при такой точности любое число помещается в буфер append
+    if (precision < 0 || precision > 100)
+      return;
+    ios_base::fmtflags f = ostr.flags() &
+        ~(ios_base::skipws | ios_base::adjustfield | ios_base::unitbuf | ios_base::boolalpha);
+    ios_base::fmtflags floatfield = f & ios_base::floatfield;
+    f &= ~ios_base::floatfield;
+    if (f != ios_base::dec && f != ios_base::fmtflags(0))
+      return;
+    if (floatfield == ios_base::fixed)
+      fmt = chars_format::fixed;
+    else if (floatfield == ios_base::scientific)
+      fmt = chars_format::scientific;
+    else if (floatfield != ios_base::fmtflags(0))
+      return;
+    fast_path = true;
+  }
+
+  bool fast() const noexcept { return fast_path; }
+
+  // дописывает val в конец out
+  void append(vector<char>& out, const T& val) const
+  {
+    char tmp[512];
+    to_chars_result res;
+    if constexpr (is_floating_point<T>::value)
+      res = to_chars(tmp, tmp + sizeof(tmp), val, fmt, precision);
+    else
+      res = to_chars(tmp, tmp + sizeof(tmp), val);
+    assert(res.ec == errc() && "element does not fit into the format buffer");
+    out.insert(out.end(), tmp, res.ptr);
+  }
+};
+
+// Запись строк [r0, r1) матрицы в буфер в формате operator<<
+template<typename T>
+void format_rows(vector<char>& out, const TDynamicMatrix<T>& m, size_t r0, size_t r1,
+                 const TElementFormatter<T>& f)
+{
+  for (size_t i = r0; i < r1; i++) {
+    const T* row = m[i].data();
+    for (size_t j = 0; j < m.size(); j++) {
+      f.append(out, row[j]);
+      out.push_back(' ');
+    }
+    out.push_back('\n');
+  }
+}
+
+// Вывод вектора; результат побайтно совпадает с operator<<
+template<typename T>
+void write_vector(ostream& ostr, const TDynamicVector<T>& v)
+{
+  TElementFormatter<T> f(ostr);
+  if (!f.fast()) {
+    ostr << v;
+    return;
+  }
+  vector<char> buf;
+  buf.reserve(WRITE_BUFFER_SIZE + 1024);
+  for (size_t i = 0; i < v.size(); i++) {
+    f.append(buf, v[i]);
+    buf.push_back(' ');
+    if (buf.size() >= WRITE_BUFFER_SIZE) {
+      ostr.write(buf.data(), buf.size());
+      buf.clear();
+    }
+  }
+  ostr.write(buf.data(), buf.size());
+  ostr.flush();
+}
+
+// Вывод матрицы. Текст собирается в большие буферы и передается в поток
+// крупными кусками с единственным сбросом в конце; результат побайтно
+// совпадает с operator<<. При parallel = true блоки строк форматируются
+// параллельно и записываются по порядку
+template<typename T>
+void write_matrix(ostream& ostr, const TDynamicMatrix<T>& m, bool parallel = false)
+{
+  TElementFormatter<T> f(ostr);
+  if (!f.fast()) {
+    ostr << m;
+    return;
+  }
+  size_t n = m.size();
+  if (!parallel) {
+    vector<char> buf;
+    buf.reserve(WRITE_BUFFER_SIZE + 1024);
+    for (size_t i = 0; i < n; i++) {
+      format_rows(buf, m, i, i + 1, f);
+      if (buf.size() >= WRITE_BUFFER_SIZE) {
+        ostr.write(buf.data(), buf.size());
+        buf.clear();
+      }
+    }
+    ostr.write(buf.data(), buf.size());
+  }
+  else {
+    // группами по нескольку блоков, чтобы не держать в памяти весь текст
+    const size_t group = 64;
+    size_t blocks = (n + WRITE_ROW_BLOCK - 1) / WRITE_ROW_BLOCK;
+    vector<vector<char>> bufs(group);
+    for (size_t g0 = 0; g0 < blocks; g0 += group) {
+      long long gn = (long long)min(group, blocks - g0);
+#pragma omp parallel for schedule(dynamic)
+      for (long long b = 0; b < gn; b++) {
+        size_t r0 = (g0 + b) * WRITE_ROW_BLOCK;
+        bufs[b].clear();
+        format_rows(bufs[b], m, r0, min(n, r0 + WRITE_ROW_BLOCK), f);
+      }
+      for (long long b = 0; b < gn; b++)
+        ostr.write(bufs[b].data(), bufs[b].size());
+    }
+  }
+  ostr.flush();
+}
+
+// Ошибка разбора текстового представления вектора или матрицы
+class matrix_parse_error : public runtime_error
+{
+  size_t elem;
+  size_t off;
+public:
+  matrix_parse_error(const string& what, size_t element, size_t offset)
+    : runtime_error(what), elem(element), off(offset) {}
+
+  // номер элемента (в порядке чтения), на котором произошла ошибка
+  size_t element() const noexcept { return elem; }
+  // смещение в байтах от начала чтения
+  size_t offset() const noexcept { return off; }
+};
+
+// Чтение чисел из потока с разбором через from_chars. Разбор не зависит
+// от локали потока. Данные забираются прямо из буфера потока (rdbuf) и
+// только те, что уже в нем есть, поэтому чтение из канала не ждет
+// заполнения целого блока
+class TNumberReader
+{
+  istream& istr;
+  streambuf* sb;
+  vector<char> buf;
+  size_t pos, end;
+  size_t base;        // смещение начала буфера от начала чтения
+  bool eof;
+
+  static bool is_space(char c)
+  {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+  }
+
+  // дочитывает данные в буфер, сохраняя непрочитанный хвост
+  bool refill()
+  {
+    if (eof)
+      return false;
+    if (pos > 0) {
+      copy(buf.begin() + pos, buf.begin() + end, buf.begin());
+      base += pos;
+      end -= pos;
+      pos = 0;
+    }
+    // sgetc() при пустом буфере потока ждет новых данных, но не забирает
+    // их; после него in_avail() - число байт, уже лежащих в буфере
+    if (sb == nullptr || sb->sgetc() == char_traits<char>::eof()) {
+      eof = true;
+      return false;
+    }
+    size_t avail = size_t(max(sb->in_avail(), streamsize(1)));
+    size_t n = min(avail, READ_BUFFER_SIZE);
+    if (buf.size() - end < n)
+      buf.resize(end + n);
+    end += size_t(sb->sgetn(buf.data() + end, streamsize(n)));
+    return true;
+  }
+public:
+  explicit TNumberReader(istream& is) : istr(is), sb(is.good() ? is.rdbuf() : nullptr), pos(0), end(0), base(0), eof(false)
+  {
+    if (sb != nullptr && istr.tie() != nullptr)
+      istr.tie()->flush();
+  }
+  TNumberReader(const TNumberReader&) = delete;
+  TNumberReader& operator=(const TNumberReader&) = delete;
+
+  // Возвращает прочитанные после последнего числа байты обратно в буфер
+  // потока. Они взяты из буфера потока последним блоком и возвращаются
+  // через sputbackc; если поток этого не позволяет, его позиция
+  // сдвигается назад (pubseekoff). Если данные закончились на последнем
+  // числе, потоку, как после operator>>, добавляется eofbit
+  ~TNumberReader()
+  {
+    for (; end > pos; end--)
+      if (sb->sputbackc(buf[end - 1]) == char_traits<char>::eof())
+        break;
+    if (end > pos)
+      sb->pubseekoff(-streamoff(end - pos), ios_base::cur, ios_base::in);
+    else if (eof) {
+      try {
+        istr.setstate(ios_base::eofbit);
+      }
+      catch (const ios_base::failure&) {
+      }
+    }
+  }
+
+  // Читает следующее число; index - номер элемента для сообщения об ошибке
+  template<typename T>
+  T next(size_t index)
+  {
+    // пропуск пробельных символов
+    for (;;) {
+      while (pos < end && is_space(buf[pos]))
+        pos++;
+      if (pos < end || !refill())
+        break;
+    }
+    if (pos == end)
+      throw matrix_parse_error("unexpected end of input at element " + to_string(index), index, base + pos);
+    // лексема должна целиком находиться в буфере
+    size_t tok_len = 0;
+    for (;;) {
+      while (pos + tok_len < end && !is_space(buf[pos + tok_len]))
+        tok_len++;
+      if (pos + tok_len < end || !refill())
+        break;
+    }
+    size_t tok_end = pos + tok_len;
+    const char* first = buf.data() + pos;
+    const char* last = buf.data() + tok_end;
+    if (last - first > 1 && *first == '+' && first[1] != '-')
+      first++;
+    T val{};
+    from_chars_result res = from_chars(first, last, val);
+    if (res.ec != errc() || res.ptr != last) {
+      string token(buf.data() + pos, buf.data() + tok_end);
+      if (token.size() > 32)
+        token = token.substr(0, 32) + "...";
+      size_t where = base + pos;
+      throw matrix_parse_error("invalid number '" + token + "' at element " + to_string(index) +
+                               " (byte offset " + to_string(where) + ")", index, where);
+    }
+    pos = tok_end;
+    return val;
+  }
+};
+
+// Ввод вектора размера v.size(); формат тот же, что у operator>>,
+// но числа разбираются через from_chars. При ошибке бросает matrix_parse_error
+template<typename T>
+void read_vector(istream& istr, TDynamicVector<T>& v)
+{
+  if constexpr (!is_arithmetic<T>::value || is_same<T, bool>::value) {
+    istr >> v;
+  }
+  else {
+    TNumberReader reader(istr);
+    T* p = v.data();
+    for (size_t i = 0; i < v.size(); i++)
+      p[i] = reader.next<T>(i);
+  }
+}
+
+// Ввод матрицы размера m.size() x m.size() построчно
+template<typename T>
+void read_matrix(istream& istr, TDynamicMatrix<T>& m)
+{
+  if constexpr (!is_arithmetic<T>::value || is_same<T, bool>::value) {
+    istr >> m;
+  }
+  else {
+    TNumberReader reader(istr);
+    size_t n = m.size();
+    for (size_t i = 0; i < n; i++) {
+      T* row = m[i].data();
+      for (size_t j = 0; j < n; j++)
+        row[j] = reader.next<T>(i * n + j);
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,462 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Представления (view) частей векторов и матриц без копирования
+
+#ifndef __MATRIX_VIEW_H__
+#define __MATRIX_VIEW_H__
+
+#include "tmatrix.h"
+#include <cstddef>
+#include <type_traits>
+
+// Представления не владеют памятью: они остаются корректными, пока жив
+// и не менял размер исходный вектор или матрица. Тип элемента может быть
+// константным (TVectorView<const double>) для доступа только на чтение.
+// Операции с представлениями - свободные функции этого файла; скалярное
+// произведение, умножение блока на вектор и gemm передают ядрам tmatrix.h
+// (dot_strided, gemv_strided, gemm_blocked) указатель и шаг. Методы классов
+// матриц, принимающие массивы (multiply(const T* x, Acc* y) у плотных,
+// ленточных и CSR-матриц), принимают data() отрезка с шагом 1. Столбец
+// (TColumnView) адресуется через массив строк и обходится поэлементно
+
+// Тип строки матрицы, на которую ссылается представление с элементами T
+template<typename T>
+using view_row_t = typename conditional<is_const<T>::value,
+    const TDynamicVector<typename remove_const<T>::type>, TDynamicVector<T>>::type;
+
+// Отрезок вектора или строки матрицы: n элементов с шагом stride
+template<typename T>
+class TVectorView
+{
+  T* p;
+  size_t n;
+  ptrdiff_t stride;
+public:
+  typedef typename remove_const<T>::type value_type;
+
+  TVectorView(T* ptr, size_t size, ptrdiff_t step = 1) : p(ptr), n(size), stride(step) {}
+  // неконстантное представление приводится к константному
+  operator TVectorView<const T>() const { return TVectorView<const T>(p, n, stride); }
+
+  size_t size() const noexcept { return n; }
+  // первый элемент и шаг между соседними элементами
+  T* data() const noexcept { return p; }
+  ptrdiff_t step() const noexcept { return stride; }
+  T& operator[](size_t ind) const { return p[ptrdiff_t(ind) * stride]; }
+  T& at(size_t ind) const
+  {
+    if (ind >= n)
+      throw out_of_range("view index out of range");
+    return (*this)[ind];
+  }
+
+  // подотрезок [first, first + count)
+  TVectorView sub(size_t first, size_t count) const
+  {
+    if (first + count > n)
+      throw out_of_range("view range out of range");
+    return TVectorView(p + ptrdiff_t(first) * stride, count, stride);
+  }
+
+  template<typename V> TVectorView& operator=(const V& v);
+  TVectorView& operator=(const TVectorView& v) { return operator=<TVectorView>(v); }
+  template<typename V> TVectorView& operator+=(const V& v);
+  template<typename V> TVectorView& operator-=(const V& v);
+  TVectorView& operator*=(const value_type& val)
+  {
+    for (size_t i = 0; i < n; i++)
+      (*this)[i] *= val;
+    return *this;
+  }
+};
+
+// Столбец матрицы (или его часть). Строки TDynamicMatrix лежат в отдельных
+// блоках памяти, поэтому столбец адресуется через массив строк
+template<typename T>
+class TColumnView
+{
+  view_row_t<T>* rows;
+  size_t col, n;
+public:
+  typedef typename remove_const<T>::type value_type;
+
+  TColumnView(view_row_t<T>* first_row, size_t column, size_t size) : rows(first_row), col(column), n(size) {}
+  operator TColumnView<const T>() const { return TColumnView<const T>(rows, col, n); }
+
+  size_t size() const noexcept { return n; }
+  T& operator[](size_t ind) const { return rows[ind].data()[col]; }
+  T& at(size_t ind) const
+  {
+    if (ind >= n)
+      throw out_of_range("view index out of range");
+    return (*this)[ind];
+  }
+
+  TColumnView sub(size_t first, size_t count) const
+  {
+    if (first + count > n)
+      throw out_of_range("view range out of range");
+    return TColumnView(rows + first, col, count);
+  }
+
+  template<typename V> TColumnView& operator=(const V& v);
+  TColumnView& operator=(const TColumnView& v) { return operator=<TColumnView>(v); }
+  template<typename V> TColumnView& operator+=(const V& v);
+  template<typename V> TColumnView& operator-=(const V& v);
+  TColumnView& operator*=(const value_type& val)
+  {
+    for (size_t i = 0; i < n; i++)
+      (*this)[i] *= val;
+    return *this;
+  }
+};
+
+template<typename V> struct is_vector_view : false_type {};
+template<typename T> struct is_vector_view<TVectorView<T>> : true_type {};
+template<typename T> struct is_vector_view<TColumnView<T>> : true_type {};
+
+template<typename V> struct is_vector_like : is_vector_view<V> {};
+template<typename T> struct is_vector_like<TDynamicVector<T>> : true_type {};
+
+template<typename V> struct vector_value { typedef typename V::value_type type; };
+template<typename T> struct vector_value<TDynamicVector<T>> { typedef T type; };
+
+// Векторы, элементы которых задаются указателем и шагом
+template<typename V> struct is_strided_vector : false_type {};
+template<typename T> struct is_strided_vector<TVectorView<T>> : true_type {};
+template<typename T> struct is_strided_vector<TDynamicVector<T>> : true_type {};
+
+template<typename T>
+const T* strided_data(const TVectorView<T>& v) { return v.data(); }
+template<typename T>
+const T* strided_data(const TDynamicVector<T>& v) { return v.data(); }
+template<typename T>
+ptrdiff_t strided_step(const TVectorView<T>& v) { return v.step(); }
+template<typename T>
+ptrdiff_t strided_step(const TDynamicVector<T>&) { return 1; }
+
+// Операции, в которых участвует хотя бы одно представление
+template<typename A, typename B>
+using enable_if_view_op = typename enable_if<is_vector_like<A>::value && is_vector_like<B>::value &&
+    (is_vector_view<A>::value || is_vector_view<B>::value)>::type;
+
+template<typename A, typename B>
+void check_view_sizes(const A& a, const B& b)
+{
+  if (a.size() != b.size())
+    throw invalid_argument("size don't match");
+}
+
+template<typename T>
+template<typename V>
+TVectorView<T>& TVectorView<T>::operator=(const V& v)
+{
+  check_view_sizes(*this, v);
+  for (size_t i = 0; i < n; i++)
+    (*this)[i] = v[i];
+  return *this;
+}
+template<typename T>
+template<typename V>
+TVectorView<T>& TVectorView<T>::operator+=(const V& v)
+{
+  check_view_sizes(*this, v);
+  for (size_t i = 0; i < n; i++)
+    (*this)[i] += v[i];
+  return *this;
+}
+template<typename T>
+template<typename V>
+TVectorView<T>& TVectorView<T>::operator-=(const V& v)
+{
+  check_view_sizes(*this, v);
+  for (size_t i = 0; i < n; i++)
+    (*this)[i] -= v[i];
+  return *this;
+}
+
+template<typename T>
+template<typename V>
+TColumnView<T>& TColumnView<T>::operator=(const V& v)
+{
+  check_view_sizes(*this, v);
+  for (size_t i = 0; i < n; i++)
+    (*this)[i] = v[i];
+  return *this;
+}
+template<typename T>
+template<typename V>
+TColumnView<T>& TColumnView<T>::operator+=(const V& v)
+{
+  check_view_sizes(*this, v);
+  for (size_t i = 0; i < n; i++)
+    (*this)[i] += v[i];
+  return *this;
+}
+template<typename T>
+template<typename V>
+TColumnView<T>& TColumnView<T>::operator-=(const V& v)
+{
+  check_view_sizes(*this, v);
+  for (size_t i = 0; i < n; i++)
+    (*this)[i] -= v[i];
+  return *this;
+}
+
+// копия представления в виде самостоятельного вектора
+template<typename V, typename = typename enable_if<is_vector_view<V>::value>::type>
+TDynamicVector<typename vector_value<V>::type> to_vector(const V& v)
+{
+  TDynamicVector<typename vector_value<V>::type> result(v.size());
+  for (size_t i = 0; i < v.size(); i++)
+    result[i] = v[i];
+  return result;
+}
+
+template<typename A, typename B, typename = enable_if_view_op<A, B>>
+TDynamicVector<typename vector_value<A>::type> operator+(const A& a, const B& b)
+{
+  check_view_sizes(a, b);
+  TDynamicVector<typename vector_value<A>::type> result(a.size());
+  for (size_t i = 0; i < a.size(); i++)
+    result[i] = a[i] + b[i];
+  return result;
+}
+
+template<typename A, typename B, typename = enable_if_view_op<A, B>>
+TDynamicVector<typename vector_value<A>::type> operator-(const A& a, const B& b)
+{
+  check_view_sizes(a, b);
+  TDynamicVector<typename vector_value<A>::type> result(a.size());
+  for (size_t i = 0; i < a.size(); i++)
+    result[i] = a[i] - b[i];
+  return result;
+}
+
+// скалярное произведение
+template<typename A, typename B, typename = enable_if_view_op<A, B>>
+typename vector_value<A>::type operator*(const A& a, const B& b)
+{
+  check_view_sizes(a, b);
+  typedef typename vector_value<A>::type value_type;
+  if constexpr (is_strided_vector<A>::value && is_strided_vector<B>::value)
+    return dot_strided<value_type>(a.size(), strided_data(a), strided_step(a), strided_data(b), strided_step(b));
+  value_type result = value_type();
+  for (size_t i = 0; i < a.size(); i++)
+    result += a[i] * b[i];
+  return result;
+}
+
+template<typename V, typename = typename enable_if<is_vector_view<V>::value>::type>
+TDynamicVector<typename vector_value<V>::type> operator*(const V& v, const typename vector_value<V>::type& val)
+{
+  TDynamicVector<typename vector_value<V>::type> result(v.size());
+  for (size_t i = 0; i < v.size(); i++)
+    result[i] = v[i] * val;
+  return result;
+}
+
+template<typename A, typename B, typename = enable_if_view_op<A, B>>
+bool operator==(const A& a, const B& b)
+{
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); i++)
+    if (a[i] != b[i])
+      return false;
+  return true;
+}
+
+template<typename A, typename B, typename = enable_if_view_op<A, B>>
+bool operator!=(const A& a, const B& b)
+{
+  return !(a == b);
+}
+
+template<typename V, typename = typename enable_if<is_vector_view<V>::value>::type>
+ostream& operator<<(ostream& ostr, const V& v)
+{
+  for (size_t i = 0; i < v.size(); i++)
+    ostr << v[i] << ' ';
+  return ostr;
+}
+
+
+// Прямоугольный блок матрицы: строки [r0, r0 + nr), столбцы [c0, c0 + nc)
+template<typename T>
+class TMatrixView
+{
+  view_row_t<T>* rws;   // первая строка блока
+  size_t c0, nr, nc;
+public:
+  typedef typename remove_const<T>::type value_type;
+
+  TMatrixView(view_row_t<T>* first_row, size_t col0, size_t rows, size_t cols)
+    : rws(first_row), c0(col0), nr(rows), nc(cols) {}
+  operator TMatrixView<const T>() const { return TMatrixView<const T>(rws, c0, nr, nc); }
+
+  size_t rows() const noexcept { return nr; }
+  size_t cols() const noexcept { return nc; }
+
+  T& operator()(size_t i, size_t j) const { return rws[i].data()[c0 + j]; }
+  // указатель на начало i-й строки блока
+  T* row_data(size_t i) const { return rws[i].data() + c0; }
+
+  TVectorView<T> row(size_t i) const
+  {
+    if (i >= nr)
+      throw out_of_range("row index out of range");
+    return TVectorView<T>(row_data(i), nc);
+  }
+  TColumnView<T> col(size_t j) const
+  {
+    if (j >= nc)
+      throw out_of_range("column index out of range");
+    return TColumnView<T>(rws, c0 + j, nr);
+  }
+  TMatrixView block(size_t r, size_t c, size_t rows, size_t cols) const
+  {
+    if (r + rows > nr || c + cols > nc)
+      throw out_of_range("block out of range");
+    return TMatrixView(rws + r, c0 + c, rows, cols);
+  }
+
+  template<typename M> TMatrixView& operator=(const M& m)
+  {
+    check_same_shape(m);
+    for (size_t i = 0; i < nr; i++)
+      for (size_t j = 0; j < nc; j++)
+        (*this)(i, j) = m(i, j);
+    return *this;
+  }
+  TMatrixView& operator=(const TMatrixView& m) { return operator=<TMatrixView>(m); }
+  template<typename M> TMatrixView& operator+=(const M& m)
+  {
+    check_same_shape(m);
+    for (size_t i = 0; i < nr; i++) {
+      T* r = row_data(i);
+      for (size_t j = 0; j < nc; j++)
+        r[j] += m(i, j);
+    }
+    return *this;
+  }
+  template<typename M> TMatrixView& operator-=(const M& m)
+  {
+    check_same_shape(m);
+    for (size_t i = 0; i < nr; i++) {
+      T* r = row_data(i);
+      for (size_t j = 0; j < nc; j++)
+        r[j] -= m(i, j);
+    }
+    return *this;
+  }
+  TMatrixView& operator*=(const value_type& val)
+  {
+    for (size_t i = 0; i < nr; i++) {
+      T* r = row_data(i);
+      for (size_t j = 0; j < nc; j++)
+        r[j] *= val;
+    }
+    return *this;
+  }
+
+  // произведение блока на вектор или представление вектора
+  template<typename V, typename = typename enable_if<is_vector_like<V>::value>::type>
+  TDynamicVector<value_type> operator*(const V& v) const
+  {
+    if (v.size() != nc)
+      throw invalid_argument("all sizes don't match");
+    TDynamicVector<value_type> result(nr);
+    if constexpr (is_strided_vector<V>::value) {
+      gemv_strided(nr, nc, [this](size_t i) { return row_data(i); }, strided_data(v), strided_step(v),
+                   result.data(), 1);
+      return result;
+    }
+    for (size_t i = 0; i < nr; i++) {
+      const T* r = row_data(i);
+      value_type s = value_type();
+      for (size_t j = 0; j < nc; j++)
+        s += r[j] * v[j];
+      result[i] = s;
+    }
+    return result;
+  }
+
+  bool operator==(const TMatrixView<const T>& m) const
+  {
+    if (nr != m.rows() || nc != m.cols())
+      return false;
+    for (size_t i = 0; i < nr; i++)
+      for (size_t j = 0; j < nc; j++)
+        if ((*this)(i, j) != m(i, j))
+          return false;
+    return true;
+  }
+  bool operator!=(const TMatrixView<const T>& m) const { return !(*this == m); }
+private:
+  template<typename M> void check_same_shape(const M& m) const
+  {
+    if (m.rows() != nr || m.cols() != nc)
+      throw invalid_argument("matrix size don't match");
+  }
+};
+
+// C += A * B для блоков матриц; использует то же блочное ядро, что и TDynamicMatrix
+template<typename T, typename U, typename W>
+void gemm(const TMatrixView<T>& c, const TMatrixView<U>& a, const TMatrixView<W>& b)
+{
+  if (a.cols() != b.rows() || c.rows() != a.rows() || c.cols() != b.cols())
+    throw invalid_argument("matrix size don't match");
+  gemm_blocked<T>(a.rows(), b.cols(), a.cols(),
+      [&a](size_t i) { return a.row_data(i); },
+      [&b](size_t k) { return b.row_data(k); },
+      [&c](size_t i) { return c.row_data(i); });
+}
+
+// Построение представлений
+template<typename T>
+TVectorView<T> range_view(TDynamicVector<T>& v, size_t first, size_t count)
+{
+  if (first + count > v.size())
+    throw out_of_range("view range out of range");
+  return TVectorView<T>(v.data() + first, count);
+}
+template<typename T>
+TVectorView<const T> range_view(const TDynamicVector<T>& v, size_t first, size_t count)
+{
+  if (first + count > v.size())
+    throw out_of_range("view range out of range");
+  return TVectorView<const T>(v.data() + first, count);
+}
+
+template<typename T>
+TMatrixView<T> block_view(TDynamicMatrix<T>& m, size_t r0, size_t c0, size_t rows, size_t cols)
+{
+  if (r0 + rows > m.size() || c0 + cols > m.size())
+    throw out_of_range("block out of range");
+  return TMatrixView<T>(&m[r0], c0, rows, cols);
+}
+template<typename T>
+TMatrixView<const T> block_view(const TDynamicMatrix<T>& m, size_t r0, size_t c0, size_t rows, size_t cols)
+{
+  if (r0 + rows > m.size() || c0 + cols > m.size())
+    throw out_of_range("block out of range");
+  return TMatrixView<const T>(&m[r0], c0, rows, cols);
+}
+
+template<typename T>
+TMatrixView<T> matrix_view(TDynamicMatrix<T>& m) { return block_view(m, 0, 0, m.size(), m.size()); }
+template<typename T>
+TMatrixView<const T> matrix_view(const TDynamicMatrix<T>& m) { return block_view(m, 0, 0, m.size(), m.size()); }
+
+template<typename T>
+TVectorView<T> row_view(TDynamicMatrix<T>& m, size_t i) { return matrix_view(m).row(i); }
+template<typename T>
+TVectorView<const T> row_view(const TDynamicMatrix<T>& m, size_t i) { return matrix_view(m).row(i); }
+
+template<typename T>
+TColumnView<T> column_view(TDynamicMatrix<T>& m, size_t j) { return matrix_view(m).col(j); }
+template<typename T>
+TColumnView<const T> column_view(const TDynamicMatrix<T>& m, size_t j) { return matrix_view(m).col(j); }
+
+#endif
@@ -0,0 +1,350 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Предобусловливатели для итерационных методов на матрицах TCSRMatrix
+
+#ifndef __PRECONDITIONERS_H__
+#define __PRECONDITIONERS_H__
+
+#include "dop_matrix.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+// Число ненулевых элементов, начиная с которого разложения и ходы
+// по уровням выполняются параллельно
+const size_t PRECOND_PARALLEL_SIZE = 1 << 14;
+// Длина системы, начиная с которой параллельны поэлементные операции
+const size_t PRECOND_VECTOR_PARALLEL_SIZE = 1 << 12;
+// Наименьшее среднее число строк на уровне, при котором параллельный
+// проход по уровням окупает синхронизацию между ними
+const size_t PRECOND_LEVEL_WIDTH = 64;
+
+// Символьная часть неполных разложений -
+// шаблон матрицы с упорядоченными столбцами и расписание по уровням для
+// прямого и обратного хода. Зависит только от расположения ненулевых
+// элементов, поэтому строится один раз для всех матриц с тем же шаблоном.
+// Строки одного уровня не зависят друг от друга и обрабатываются параллельно
+struct TCSRSymbolic
+{
+  int n = 0;
+  vector<int> ptr, col;           // шаблон; столбцы в строке по возрастанию
+  vector<int> src;                // src[k] - номер элемента k в массивах исходной матрицы
+  vector<int> diag;               // diag[i] - позиция диагонального элемента строки i
+  vector<int> lower_ptr, lower_rows;  // уровни прямого хода: строки lower_rows[lower_ptr[l]..lower_ptr[l + 1])
+  vector<int> upper_ptr, upper_rows;  // уровни обратного хода
+  bool lower_parallel = false, upper_parallel = false;
+
+  template<typename T>
+  explicit TCSRSymbolic(const TCSRMatrix<T>& a) : n(a.get_rows())
+  {
+    if (a.get_rows() != a.get_cols())
+      throw invalid_argument("system matrix should be square");
+    const int* rp = a.row_index_data();
+    const int* ci = a.col_indices_data();
+    int nnz = rp[n];
+    ptr.assign(rp, rp + n + 1);
+    col.resize(nnz);
+    src.resize(nnz);
+    diag.assign(n, -1);
+    for (int i = 0; i < n; i++) {
+      iota(src.begin() + ptr[i], src.begin() + ptr[i + 1], ptr[i]);
+      sort(src.begin() + ptr[i], src.begin() + ptr[i + 1], [ci](int p, int q) { return ci[p] < ci[q]; });
+      for (int k = ptr[i]; k < ptr[i + 1]; k++) {
+        col[k] = ci[src[k]];
+        if (col[k] == i)
+          diag[i] = k;
+      }
+      if (diag[i] < 0)
+        throw invalid_argument("matrix pattern should contain the whole diagonal");
+    }
+    lower_parallel = build_levels(true, lower_ptr, lower_rows);
+    upper_parallel = build_levels(false, upper_ptr, upper_rows);
+  }
+
+  // совпадает ли шаблон a с разобранным
+  template<typename T>
+  bool matches(const TCSRMatrix<T>& a) const
+  {
+    if (a.get_rows() != n || a.get_cols() != n)
+      return false;
+    const int* rp = a.row_index_data();
+    const int* ci = a.col_indices_data();
+    if (!equal(ptr.begin(), ptr.end(), rp))
+      return false;
+    for (size_t k = 0; k < col.size(); k++)
+      if (ci[src[k]] != col[k])
+        return false;
+    return true;
+  }
+
+  // значения a в порядке упорядоченного шаблона
+  template<typename T>
+  void gather(const TCSRMatrix<T>& a, T* dst) const
+  {
+    if (!matches(a))
+      throw invalid_argument("matrix pattern differs from the analysed one");
+    const T* v = a.values_data();
+    for (size_t k = 0; k < src.size(); k++)
+      dst[k] = v[src[k]];
+  }
+
+private:
+  // Уровень строки на единицу больше наибольшего уровня строк, от которых
+  // она зависит (столбцы левее диагонали для прямого хода, правее - для
+  // обратного). Возвращает, стоит ли обрабатывать уровни параллельно
+  bool build_levels(bool lower, vector<int>& lptr, vector<int>& rows) const
+  {
+    vector<int> level(n, 0);
+    int nlev = 0;
+    for (int t = 0; t < n; t++) {
+      int i = lower ? t : n - 1 - t;
+      int lv = 0;
+      int k0 = lower ? ptr[i] : diag[i] + 1;
+      int k1 = lower ? diag[i] : ptr[i + 1];
+      for (int k = k0; k < k1; k++)
+        lv = max(lv, level[col[k]] + 1);
+      level[i] = lv;
+      nlev = max(nlev, lv + 1);
+    }
+    lptr.assign(nlev + 1, 0);
+    for (int i = 0; i < n; i++)
+      lptr[level[i] + 1]++;
+    partial_sum(lptr.begin(), lptr.end(), lptr.begin());
+    rows.resize(n);
+    vector<int> fill(lptr.begin(), lptr.end() - 1);
+    for (int i = 0; i < n; i++)
+      rows[fill[level[i]]++] = i;
+    return col.size() >= PRECOND_PARALLEL_SIZE && size_t(n) / size_t(nlev) >= PRECOND_LEVEL_WIDTH;
+  }
+};
+
+// Прямой ход L y = r по уровням. f - значения в порядке s; при unit
+// диагональ L считается единичной
+template<typename T>
+void level_lower_solve(const TCSRSymbolic& s, const T* f, const T* r, T* y, bool unit)
+{
+  const int* ptr = s.ptr.data();
+  const int* col = s.col.data();
+  const int* diag = s.diag.data();
+#pragma omp parallel if (s.lower_parallel)
+  for (size_t l = 0; l + 1 < s.lower_ptr.size(); l++) {
+#pragma omp for schedule(static)
+    for (long long q = s.lower_ptr[l]; q < s.lower_ptr[l + 1]; q++) {
+      int i = s.lower_rows[q];
+      T sum = r[i];
+      for (int k = ptr[i]; k < diag[i]; k++)
+        sum -= f[k] * y[col[k]];
+      y[i] = unit ? sum : sum / f[diag[i]];
+    }
+  }
+}
+
+// Обратный ход U y = r по уровням; y может совпадать с r
+template<typename T>
+void level_upper_solve(const TCSRSymbolic& s, const T* f, const T* r, T* y)
+{
+  const int* ptr = s.ptr.data();
+  const int* col = s.col.data();
+  const int* diag = s.diag.data();
+#pragma omp parallel if (s.upper_parallel)
+  for (size_t l = 0; l + 1 < s.upper_ptr.size(); l++) {
+#pragma omp for schedule(static)
+    for (long long q = s.upper_ptr[l]; q < s.upper_ptr[l + 1]; q++) {
+      int i = s.upper_rows[q];
+      T sum = r[i];
+      for (int k = diag[i] + 1; k < ptr[i + 1]; k++)
+        sum -= f[k] * y[col[k]];
+      y[i] = sum / f[diag[i]];
+    }
+  }
+}
+
+// Предобусловливатель Якоби: z = D^{-1} r, D - диагональ матрицы
+template<typename T>
+class TJacobiPreconditioner
+{
+  vector<T> inv;
+public:
+  explicit TJacobiPreconditioner(const TCSRMatrix<T>& a) { refactor(a); }
+
+  // пересчет для новых значений матрицы
+  void refactor(const TCSRMatrix<T>& a)
+  {
+    if (a.get_rows() != a.get_cols())
+      throw invalid_argument("system matrix should be square");
+    int n = a.get_rows();
+    const int* rp = a.row_index_data();
+    const int* ci = a.col_indices_data();
+    const T* v = a.values_data();
+    inv.assign(n, T());
+    for (int i = 0; i < n; i++) {
+      for (int k = rp[i]; k < rp[i + 1]; k++)
+        if (ci[k] == i)
+          inv[i] = v[k];
+      if (inv[i] == T())
+        throw runtime_error("zero diagonal element in Jacobi preconditioner");
+      inv[i] = T(1) / inv[i];
+    }
+  }
+
+  void apply(const T* r, T* z) const
+  {
+    const long long n = (long long)inv.size();
+    const T* d = inv.data();
+#pragma omp parallel for schedule(static) if (inv.size() >= PRECOND_VECTOR_PARALLEL_SIZE)
+    for (long long i = 0; i < n; i++)
+      z[i] = d[i] * r[i];
+  }
+
+  size_t size() const noexcept { return inv.size(); }
+};
+
+// Неполное LU-разложение без заполнения ILU(0): L (с единичной диагональю)
+// и U имеют тот же шаблон, что и нижняя и верхняя части A.
+// Строка i использует только строки k < i из своего шаблона, поэтому
+// разложение, как и прямой ход, выполняется по уровням
+template<typename T>
+class TILU0Preconditioner
+{
+  TCSRSymbolic s;
+  vector<T> lu;       // L ниже диагонали, U - на диагонали и выше
+public:
+  explicit TILU0Preconditioner(const TCSRMatrix<T>& a) : s(a), lu(s.col.size())
+  {
+    refactor(a);
+  }
+
+  // Численное разложение матрицы с тем же шаблоном; символьная часть
+  // переиспользуется. Бросает runtime_error при нулевом ведущем элементе
+  void refactor(const TCSRMatrix<T>& a)
+  {
+    s.gather(a, lu.data());
+    const int* ptr = s.ptr.data();
+    const int* col = s.col.data();
+    const int* diag = s.diag.data();
+    T* f = lu.data();
+#pragma omp parallel if (s.lower_parallel)
+    for (size_t l = 0; l + 1 < s.lower_ptr.size(); l++) {
+#pragma omp for schedule(dynamic, 16)
+      for (long long q = s.lower_ptr[l]; q < s.lower_ptr[l + 1]; q++) {
+        int i = s.lower_rows[q];
+        for (int kk = ptr[i]; kk < diag[i]; kk++) {
+          int k = col[kk];
+          T lik = f[kk] /= f[diag[k]];
+          // строка i -= lik * (строка k правее диагонали) в пределах шаблона
+          int p = kk + 1;
+          for (int m = diag[k] + 1; m < ptr[k + 1] && p < ptr[i + 1]; m++) {
+            while (p < ptr[i + 1] && col[p] < col[m])
+              p++;
+            if (p < ptr[i + 1] && col[p] == col[m])
+              f[p] -= lik * f[m];
+          }
+        }
+      }
+    }
+    for (int i = 0; i < s.n; i++)
+      if (f[diag[i]] == T())
+        throw runtime_error("zero pivot in ILU(0)");
+  }
+
+  // z = (LU)^{-1} r
+  void apply(const T* r, T* z) const
+  {
+    level_lower_solve(s, lu.data(), r, z, true);
+    level_upper_solve(s, lu.data(), z, z);
+  }
+
+  size_t size() const noexcept { return size_t(s.n); }
+  const TCSRSymbolic& symbolic() const noexcept { return s; }
+};
+
+// Неполное разложение Холецкого без заполнения IC(0): A ~ L L^T, L имеет
+// шаблон нижней части A. Шаблон A должен быть симметричным; L^T хранится
+// в верхней части того же шаблона, и обратный ход идет по его уровням
+template<typename T>
+class TIC0Preconditioner
+{
+  TCSRSymbolic s;
+  vector<int> tpos;   // tpos[k] - позиция элемента, симметричного элементу k нижней части
+  vector<T> ll;
+public:
+  explicit TIC0Preconditioner(const TCSRMatrix<T>& a) : s(a), tpos(s.col.size(), -1), ll(s.col.size())
+  {
+    // каждый элемент нижней части имеет пару в верхней, и их поровну
+    size_t lower = 0;
+    for (int i = 0; i < s.n; i++)
+      lower += size_t(s.diag[i] - s.ptr[i]);
+    if (2 * lower + size_t(s.n) != s.col.size())
+      throw invalid_argument("IC(0) requires a symmetric pattern");
+    for (int i = 0; i < s.n; i++)
+      for (int k = s.ptr[i]; k < s.diag[i]; k++) {
+        int j = s.col[k];
+        auto first = s.col.begin() + s.diag[j] + 1, last = s.col.begin() + s.ptr[j + 1];
+        auto it = lower_bound(first, last, i);
+        if (it == last || *it != i)
+          throw invalid_argument("IC(0) requires a symmetric pattern");
+        tpos[k] = int(it - s.col.begin());
+      }
+    refactor(a);
+  }
+
+  // Численное разложение матрицы с тем же шаблоном. Бросает runtime_error,
+  // если разложение не существует (матрица не является положительно определенной)
+  void refactor(const TCSRMatrix<T>& a)
+  {
+    s.gather(a, ll.data());
+    const int* ptr = s.ptr.data();
+    const int* col = s.col.data();
+    const int* diag = s.diag.data();
+    T* f = ll.data();
+#pragma omp parallel if (s.lower_parallel)
+    for (size_t l = 0; l + 1 < s.lower_ptr.size(); l++) {
+#pragma omp for schedule(dynamic, 16)
+      for (long long q = s.lower_ptr[l]; q < s.lower_ptr[l + 1]; q++) {
+        int i = s.lower_rows[q];
+        T d = f[diag[i]];
+        for (int kk = ptr[i]; kk < diag[i]; kk++) {
+          int k = col[kk];
+          // l_ik = (a_ik - sum_{j<k} l_ij l_kj) / l_kk
+          T sum = f[kk];
+          int p = ptr[i], m = ptr[k];
+          while (p < kk && m < diag[k]) {
+            if (col[p] == col[m])
+              sum -= f[p++] * f[m++];
+            else if (col[p] < col[m])
+              p++;
+            else
+              m++;
+          }
+          f[kk] = sum / f[diag[k]];
+          d -= f[kk] * f[kk];
+        }
+        f[diag[i]] = d > T() ? T(sqrt(d)) : T();
+      }
+    }
+    for (int i = 0; i < s.n; i++)
+      if (!(f[diag[i]] > T()))
+        throw runtime_error("IC(0) breakdown: matrix is not positive definite");
+    // L^T в верхнюю часть шаблона
+#pragma omp parallel for schedule(static) if (s.col.size() >= PRECOND_PARALLEL_SIZE)
+    for (long long i = 0; i < s.n; i++)
+      for (int k = ptr[i]; k < diag[i]; k++)
+        f[tpos[k]] = f[k];
+  }
+
+  // z = (L L^T)^{-1} r
+  void apply(const T* r, T* z) const
+  {
+    level_lower_solve(s, ll.data(), r, z, false);
+    level_upper_solve(s, ll.data(), z, z);
+  }
+
+  size_t size() const noexcept { return size_t(s.n); }
+  const TCSRSymbolic& symbolic() const noexcept { return s; }
+};
+
+#endif
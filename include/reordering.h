@@ -0,0 +1,249 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Упорядочение Катхилла-Макки (RCM) для сужения ленты разреженной матрицы
+
+#ifndef __REORDERING_H__
+#define __REORDERING_H__
+
+#include "csc_matrix.h"
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+// Лента считается узкой, если в ней не больше этой доли от порядка матрицы
+const double RCM_NARROW_FRACTION = 0.1;
+
+// Ширина ленты: наибольшие расстояния ненулевых элементов от главной
+// диагонали снизу и сверху
+struct TBandwidth
+{
+  int lower = 0, upper = 0;
+
+  int width() const noexcept { return lower + upper + 1; }
+};
+
+template<typename T>
+TBandwidth bandwidth(const TCSRMatrix<T>& a)
+{
+  TBandwidth bw;
+  a.band_widths(bw.lower, bw.upper);
+  return bw;
+}
+
+// Граф матрицы A + A^T без петель: соседи вершины i - adj[ptr[i]..ptr[i + 1])
+struct TMatrixGraph
+{
+  vector<int> ptr, adj;
+
+  template<typename T>
+  explicit TMatrixGraph(const TCSRMatrix<T>& a)
+  {
+    int n = a.get_rows();
+    if (n != a.get_cols())
+      throw invalid_argument("matrix should be square");
+    const int* ap = a.row_index_data();
+    const int* ac = a.col_indices_data();
+    size_t nnz = size_t(a.non_zeros());
+    // шаблон A^T строится той же сортировкой подсчетом, что и CSC
+    vector<int> tp(size_t(n) + 1), tc(nnz);
+    vector<char> tv(nnz), av(nnz);
+    sparse_transpose(n, n, ap, ac, av.data(), tp.data(), tc.data(), tv.data());
+    // строки A и A^T сливаются в область строки i массива merged, начинающуюся
+    // с ap[i] + tp[i]; повторы и диагональ отбрасываются
+    vector<int> merged(2 * nnz), count(n);
+    const bool parallel = nnz > CONVERT_PARALLEL_SIZE;
+#pragma omp parallel for schedule(static) if (parallel)
+    for (int i = 0; i < n; i++) {
+      int* row = merged.data() + ap[i] + tp[i];
+      int len = ap[i + 1] - ap[i];
+      copy(ac + ap[i], ac + ap[i + 1], row);
+      sort(row, row + len);
+      // строка A^T уже упорядочена
+      int* end = copy(tc.begin() + tp[i], tc.begin() + tp[i + 1], row + len);
+      inplace_merge(row, row + len, end);
+      end = unique(row, end);
+      count[i] = int(remove(row, end, i) - row);
+    }
+    ptr.assign(size_t(n) + 1, 0);
+    for (int i = 0; i < n; i++)
+      ptr[i + 1] = ptr[i] + count[i];
+    adj.resize(ptr[n]);
+#pragma omp parallel for schedule(static) if (parallel)
+    for (int i = 0; i < n; i++)
+      copy_n(merged.data() + ap[i] + tp[i], count[i], adj.data() + ptr[i]);
+  }
+
+  int size() const noexcept { return int(ptr.size()) - 1; }
+  int degree(int i) const noexcept { return ptr[i + 1] - ptr[i]; }
+};
+
+// Обход в ширину от s по непосещенным вершинам (level[v] < 0). Вершины
+// записываются в order по уровням, level получает номер уровня;
+// соседи добавляются по возрастанию степени. Возвращает число уровней
+inline int rcm_bfs(const TMatrixGraph& g, int s, vector<int>& level, vector<int>& order)
+{
+  order.clear();
+  order.push_back(s);
+  level[s] = 0;
+  int depth = 0;
+  for (size_t head = 0; head < order.size(); head++) {
+    int v = order[head];
+    size_t first = order.size();
+    for (int k = g.ptr[v]; k < g.ptr[v + 1]; k++) {
+      int u = g.adj[k];
+      if (level[u] < 0) {
+        level[u] = level[v] + 1;
+        depth = max(depth, level[u]);
+        order.push_back(u);
+      }
+    }
+    stable_sort(order.begin() + first, order.end(),
+                [&g](int x, int y) { return g.degree(x) < g.degree(y); });
+  }
+  return depth + 1;
+}
+
+// Упорядочение RCM: perm[новый номер] = старый номер.
+// Каждая связная компонента обходится в ширину от псевдопериферийной
+// вершины (алгоритм Джорджа-Лю: обход повторяется от вершины наименьшей
+// степени на последнем уровне, пока число уровней растет), затем порядок
+// обращается. Время O(nnz log d), где d - наибольшая степень
+template<typename T>
+vector<int> rcm_ordering(const TCSRMatrix<T>& a)
+{
+  TMatrixGraph g(a);
+  int n = g.size();
+  vector<int> level(n, -1), order, perm;
+  perm.reserve(n);
+  vector<int> by_degree(n);
+  for (int i = 0; i < n; i++)
+    by_degree[i] = i;
+  stable_sort(by_degree.begin(), by_degree.end(), [&g](int x, int y) { return g.degree(x) < g.degree(y); });
+  for (int s : by_degree) {
+    if (level[s] >= 0)
+      continue;
+    int depth = rcm_bfs(g, s, level, order);
+    for (;;) {
+      int last = level[order.back()], best = order.back();
+      for (size_t k = order.size(); k-- > 0 && level[order[k]] == last;)
+        if (g.degree(order[k]) <= g.degree(best))
+          best = order[k];
+      for (int v : order)
+        level[v] = -1;
+      int d = rcm_bfs(g, best, level, order);
+      if (d <= depth)
+        break;
+      depth = d;
+    }
+    perm.insert(perm.end(), order.begin(), order.end());
+  }
+  reverse(perm.begin(), perm.end());
+  return perm;
+}
+
+// Симметричная перестановка B = P A P^T: b(i, j) = a(perm[i], perm[j]).
+// Строки переставляются параллельно, столбцы в строках упорядочены
+template<typename T>
+TCSRMatrix<T> permute(const TCSRMatrix<T>& a, const vector<int>& perm)
+{
+  int n = a.get_rows();
+  if (n != a.get_cols() || perm.size() != size_t(n))
+    throw invalid_argument("permutation size don't match");
+  vector<int> inv(n, -1);
+  for (int i = 0; i < n; i++) {
+    if (perm[i] < 0 || perm[i] >= n || inv[perm[i]] >= 0)
+      throw invalid_argument("invalid permutation");
+    inv[perm[i]] = i;
+  }
+  const int* ap = a.row_index_data();
+  const int* ac = a.col_indices_data();
+  const T* av = a.values_data();
+  TTrackedVector<int> ptr(size_t(n) + 1, 0), col(size_t(a.non_zeros()));
+  TTrackedVector<T> val(size_t(a.non_zeros()));
+  for (int i = 0; i < n; i++)
+    ptr[i + 1] = ptr[i] + ap[perm[i] + 1] - ap[perm[i]];
+  const bool parallel = size_t(a.non_zeros()) > CONVERT_PARALLEL_SIZE;
+#pragma omp parallel if (parallel)
+  {
+    vector<pair<int, T>> row;
+#pragma omp for schedule(static)
+    for (int i = 0; i < n; i++) {
+      int r = perm[i];
+      row.clear();
+      for (int k = ap[r]; k < ap[r + 1]; k++)
+        row.emplace_back(inv[ac[k]], av[k]);
+      sort(row.begin(), row.end(), [](const pair<int, T>& x, const pair<int, T>& y) { return x.first < y.first; });
+      for (size_t k = 0; k < row.size(); k++) {
+        col[ptr[i] + k] = row[k].first;
+        val[ptr[i] + k] = row[k].second;
+      }
+    }
+  }
+  return TCSRMatrix<T>(n, n, move(ptr), move(col), move(val));
+}
+
+// Результат упорядочения: перестановка, переставленная матрица и ширина
+// ленты до и после
+template<typename T>
+struct TRCMResult
+{
+  vector<int> perm;
+  TCSRMatrix<T> matrix;
+  TBandwidth before, after;
+
+  // лента переставленной матрицы занимает не больше fraction от ее порядка
+  bool is_narrow(double fraction = RCM_NARROW_FRACTION) const
+  {
+    return after.width() <= max(1, int(fraction * matrix.get_rows()));
+  }
+};
+
+template<typename T>
+TRCMResult<T> rcm_reorder(const TCSRMatrix<T>& a)
+{
+  vector<int> perm = rcm_ordering(a);
+  TCSRMatrix<T> b = permute(a, perm);
+  TBandwidth before = bandwidth(a), after = bandwidth(b);
+  return TRCMResult<T>{ move(perm), move(b), before, after };
+}
+
+// Ленточная матрица, если лента после упорядочения узкая
+template<typename T>
+optional<TGeneralBandMatrix<T>> rcm_band(const TRCMResult<T>& r, double fraction = RCM_NARROW_FRACTION)
+{
+  if (!r.is_narrow(fraction))
+    return nullopt;
+  return r.matrix.to_band();
+}
+
+// Симметричная ленточная матрица, если лента узкая, а матрица симметрична
+template<typename T>
+optional<TSymmetricBandMatrix<T>> rcm_symmetric_band(const TRCMResult<T>& r, double fraction = RCM_NARROW_FRACTION)
+{
+  if (!r.is_narrow(fraction) || r.after.lower != r.after.upper)
+    return nullopt;
+  const TCSRMatrix<T>& m = r.matrix;
+  const int* ptr = m.row_index_data();
+  const int* col = m.col_indices_data();
+  const T* val = m.values_data();
+  int n = m.get_rows();
+  // столбцы в строках упорядочены, поэтому пара a_ji ищется двоичным поиском
+  for (int i = 0; i < n; i++)
+    for (int k = ptr[i]; k < ptr[i + 1]; k++) {
+      int j = col[k];
+      const int* p = lower_bound(col + ptr[j], col + ptr[j + 1], i);
+      if (p == col + ptr[j + 1] || *p != i || val[p - col] != val[k])
+        return nullopt;
+    }
+  TSymmetricBandMatrix<T> band(n, r.after.upper);
+  for (int i = 0; i < n; i++)
+    for (int k = ptr[i]; k < ptr[i + 1]; k++)
+      if (col[k] >= i)
+        band.diagonal_data(col[k] - i)[i] = val[k];
+  return band;
+}
+
+#endif
@@ -0,0 +1,134 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Формат SELL-C-σ (sliced ELLPACK) для векторизованного умножения на вектор
+
+#ifndef __SELL_MATRIX_H__
+#define __SELL_MATRIX_H__
+
+#include "dop_matrix.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+// Число порций, начиная с которого умножение выполняется параллельно
+const size_t SELL_PARALLEL_SIZE = 1024;
+
+// Матрица в формате SELL-C-σ -
+// строки объединяются в порции по C, и все строки порции дополняются нулями
+// до длины самой длинной из них. Внутри порции элементы лежат по столбцам:
+// сначала первые элементы всех C строк, затем вторые и т.д., поэтому
+// умножение на вектор обрабатывает C строк одной векторной операцией.
+// Чтобы в порцию попадали строки близкой длины, в каждом окне из sigma
+// строк они упорядочиваются по убыванию длины; perm хранит исходные номера
+template<typename T, size_t C = 8>
+class TSELLMatrix
+{
+  static_assert(C > 0, "chunk size must be positive");
+
+  int nr, nc, sigma;
+  TTrackedVector<int> perm;        // perm[p] - исходный номер строки на месте p
+  TTrackedVector<int> chunk_index; // начала порций в values и cols
+  TTrackedVector<int> chunk_len;   // длина строк порции с учетом дополнения
+  TTrackedVector<int> cols;        // номера столбцов, у дополнения - 0
+  TTrackedVector<T> values;        // значения, у дополнения - 0
+  size_t nnz;
+public:
+  // Из CSR-матрицы; sigma - размер окна сортировки, кратный C.
+  // sigma = C оставляет строки на месте: сортировка внутри порции не меняет
+  // ее длину, поэтому она пропускается. sigma >= rows сортирует все строки
+  explicit TSELLMatrix(const TCSRMatrix<T>& a, int sigma = int(16 * C))
+    : nr(a.get_rows()), nc(a.get_cols()), sigma(sigma), nnz(size_t(a.non_zeros()))
+  {
+    if (sigma <= 0 || sigma % int(C) != 0)
+      throw invalid_argument("sigma must be a positive multiple of the chunk size");
+    const int* ptr = a.row_index_data();
+    const int* col = a.col_indices_data();
+    const T* val = a.values_data();
+    const int chunks = (nr + int(C) - 1) / int(C);
+    const bool parallel = size_t(chunks) >= SELL_PARALLEL_SIZE;
+    perm.resize(nr);
+    iota(perm.begin(), perm.end(), 0);
+    if (sigma > int(C)) {
+#pragma omp parallel for schedule(static) if (parallel)
+      for (int w = 0; w < nr; w += sigma)
+        stable_sort(perm.begin() + w, perm.begin() + min(nr, w + sigma),
+                    [ptr](int i, int j) { return ptr[i + 1] - ptr[i] > ptr[j + 1] - ptr[j]; });
+    }
+    chunk_len.resize(chunks);
+    chunk_index.resize(size_t(chunks) + 1);
+    chunk_index[0] = 0;
+    for (int c = 0; c < chunks; c++) {
+      // длина порции - наибольшая длина ее строк
+      chunk_len[c] = 0;
+      for (size_t p = size_t(c) * C; p < min(size_t(c + 1) * C, size_t(nr)); p++)
+        chunk_len[c] = max(chunk_len[c], ptr[perm[p] + 1] - ptr[perm[p]]);
+      chunk_index[c + 1] = chunk_index[c] + chunk_len[c] * int(C);
+    }
+    cols.resize(chunk_index[chunks]);
+    values.resize(chunk_index[chunks]);
+#pragma omp parallel for schedule(static) if (parallel)
+    for (int c = 0; c < chunks; c++) {
+      for (size_t r = 0; r < C && size_t(c) * C + r < size_t(nr); r++) {
+        int i = perm[size_t(c) * C + r];
+        for (int k = ptr[i]; k < ptr[i + 1]; k++) {
+          size_t pos = size_t(chunk_index[c]) + size_t(k - ptr[i]) * C + r;
+          cols[pos] = col[k];
+          values[pos] = val[k];
+        }
+      }
+    }
+  }
+
+  int get_rows() const noexcept { return nr; }
+  int get_cols() const noexcept { return nc; }
+  int get_sigma() const noexcept { return sigma; }
+  int non_zeros() const noexcept { return int(nnz); }
+  // число хранимых элементов вместе с дополнением
+  size_t stored_elements() const noexcept { return values.size(); }
+  // доля дополнения: stored_elements() / non_zeros()
+  double fill_ratio() const noexcept { return nnz == 0 ? 1.0 : double(values.size()) / double(nnz); }
+  const int* permutation_data() const noexcept { return perm.data(); }
+
+  // y = A * x; x - массив длины cols, y - длины rows.
+  // Все C строк порции накапливаются одновременно: внутренний цикл по
+  // строкам читает подряд лежащие значения и векторизуется целиком
+  void multiply(const T* x, T* y) const
+  {
+    const int chunks = int(chunk_len.size());
+#pragma omp parallel for schedule(static) if (size_t(chunks) >= SELL_PARALLEL_SIZE)
+    for (int c = 0; c < chunks; c++) {
+      T acc[C] = {};
+      const T* v = values.data() + chunk_index[c];
+      const int* j = cols.data() + chunk_index[c];
+      for (int k = 0; k < chunk_len[c]; k++, v += C, j += C)
+        for (size_t r = 0; r < C; r++)
+          acc[r] += v[r] * x[j[r]];
+      size_t rows = min(C, size_t(nr) - size_t(c) * C);
+      for (size_t r = 0; r < rows; r++)
+        y[perm[size_t(c) * C + r]] = acc[r];
+    }
+  }
+  TDynamicVector<T> operator*(const TDynamicVector<T>& v) const
+  {
+    if (size_t(nc) != v.size())
+      throw invalid_argument("all sizes don't match");
+    TDynamicVector<T> result(nr);
+    multiply(v.data(), result.data());
+    return result;
+  }
+
+  // объем памяти в байтах, массивы - по выделенной емкости
+  size_t memory_bytes() const noexcept
+  {
+    return sizeof(*this) + heap_block_bytes(values.capacity() * sizeof(T), alignof(T))
+        + heap_block_bytes(cols.capacity() * sizeof(int), alignof(int))
+        + heap_block_bytes(perm.capacity() * sizeof(int), alignof(int))
+        + heap_block_bytes(chunk_index.capacity() * sizeof(int), alignof(int))
+        + heap_block_bytes(chunk_len.capacity() * sizeof(int), alignof(int));
+  }
+};
+
+#endif
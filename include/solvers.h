@@ -0,0 +1,630 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Итерационные методы решения систем линейных уравнений
+
+#ifndef __SOLVERS_H__
+#define __SOLVERS_H__
+
+#include "dop_matrix.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Длина векторов, начиная с которой векторные операции выполняются параллельно
+const size_t SOLVER_PARALLEL_SIZE = 1 << 12;
+// Наибольшее число записей истории, под которое память выделяется заранее
+const size_t SOLVER_HISTORY_RESERVE = 1 << 16;
+
+// Параметры итерационного метода
+struct TSolverOptions
+{
+  double tolerance = 1e-8;          // требуемая относительная невязка ||b - Ax|| / ||b||
+  size_t max_iterations = 1000;     // наибольшее число итераций
+  bool record_history = true;       // сохранять ли сведения о каждой итерации
+  size_t restart = 30;              // размерность подпространства Крылова в GMRES(m)
+};
+
+// Сведения об одной итерации
+struct TSolverIteration
+{
+  size_t iteration;                 // номер итерации, начиная с 1
+  double residual;                  // относительная невязка после итерации
+  double seconds;                   // время выполнения итерации
+};
+
+// Результат работы метода
+struct TSolverReport
+{
+  bool converged = false;           // достигнута ли требуемая точность
+  size_t iterations = 0;            // выполнено итераций
+  bool breakdown = false;           // остановка из-за вырождения метода
+  double residual = 0.0;            // итоговая относительная невязка
+  vector<TSolverIteration> history; // по итерации на элемент, если record_history
+};
+
+// Рабочая память методов подпространств Крылова -
+// count векторов длины n, лежащих подряд, и extra скалярных ячеек за ними.
+// Память выделяется только при росте запроса, поэтому одна рабочая область
+// может переиспользоваться многими решениями систем одного размера
+template<typename T>
+class TKrylovWorkspace
+{
+  size_t len = 0, cnt = 0;
+  vector<T> mem;
+public:
+  void reserve(size_t n, size_t count, size_t extra = 0)
+  {
+    if (n * count + extra > mem.size())
+      mem.resize(n * count + extra);
+    len = n;
+    cnt = count;
+  }
+
+  // k-й вектор
+  T* vec(size_t k) { return mem.data() + k * len; }
+  // скалярные ячейки
+  T* extra() { return mem.data() + cnt * len; }
+  // расстояние между соседними векторами
+  size_t stride() const noexcept { return len; }
+  // выделено элементов
+  size_t capacity() const noexcept { return mem.size(); }
+};
+
+// Порядок системы; матрица должна быть квадратной
+template<typename T>
+size_t system_size(const TCSRMatrix<T>& a)
+{
+  if (a.get_rows() != a.get_cols())
+    throw invalid_argument("system matrix should be square");
+  return size_t(a.get_rows());
+}
+
+template<typename T>
+size_t system_size(const TGeneralBandMatrix<T>& a)
+{
+  return size_t(a.size());
+}
+
+// Скалярное произведение массивов длины n
+template<typename T>
+T solver_dot(const T* x, const T* y, size_t n)
+{
+  T sum = T();
+#pragma omp parallel for schedule(static) reduction(+:sum) if (n >= SOLVER_PARALLEL_SIZE)
+  for (long long i = 0; i < (long long)n; i++)
+    sum += x[i] * y[i];
+  return sum;
+}
+
+// Длина блока, в пределах которого пакетные операции с несколькими векторами
+// проходят все векторы, пока блок w остается в кэше
+const size_t SOLVER_BATCH_BLOCK = 256;
+
+// h[j] = (V_j, w) для j < k, где V_j = v + j * ld. Все k произведений
+// считаются за один проход по w. Каждый поток копит свои суммы и
+// добавляет их к h в критической секции: редукция по массиву (h[:k])
+// требует OpenMP 4.5, а MSVC поддерживает только OpenMP 2.0
+template<typename T>
+void solver_multi_dot(const T* v, size_t ld, size_t k, const T* w, size_t n, T* h)
+{
+  for (size_t j = 0; j < k; j++)
+    h[j] = T();
+#pragma omp parallel if (n >= SOLVER_PARALLEL_SIZE)
+  {
+    vector<T> part(k);
+#pragma omp for schedule(static)
+    for (long long i0 = 0; i0 < (long long)n; i0 += SOLVER_BATCH_BLOCK) {
+      size_t i1 = min(n, size_t(i0) + SOLVER_BATCH_BLOCK);
+      for (size_t j = 0; j < k; j++) {
+        const T* vj = v + j * ld;
+        T sum = T();
+        for (size_t i = size_t(i0); i < i1; i++)
+          sum += vj[i] * w[i];
+        part[j] += sum;
+      }
+    }
+#pragma omp critical
+    for (size_t j = 0; j < k; j++)
+      h[j] += part[j];
+  }
+}
+
+// w -= h[0] V_0 + ... + h[k-1] V_{k-1} за один проход по w; возвращает (w, w)
+template<typename T>
+T solver_multi_axpy(const T* v, size_t ld, size_t k, const T* h, T* w, size_t n)
+{
+  T ww = T();
+#pragma omp parallel for schedule(static) reduction(+:ww) if (n >= SOLVER_PARALLEL_SIZE)
+  for (long long i0 = 0; i0 < (long long)n; i0 += SOLVER_BATCH_BLOCK) {
+    size_t i1 = min(n, size_t(i0) + SOLVER_BATCH_BLOCK);
+    for (size_t j = 0; j < k; j++) {
+      const T* vj = v + j * ld;
+      const T hj = h[j];
+      for (size_t i = size_t(i0); i < i1; i++)
+        w[i] -= hj * vj[i];
+    }
+    for (size_t i = size_t(i0); i < i1; i++)
+      ww += w[i] * w[i];
+  }
+  return ww;
+}
+
+// Проверка размеров и норма правой части. При нулевой правой части
+// решение (нулевое) записывается в x и возвращается 0
+template<class Matrix, typename T>
+double solver_prepare(const Matrix& a, const TDynamicVector<T>& b, TDynamicVector<T>& x)
+{
+  size_t n = system_size(a);
+  if (b.size() != n || x.size() != n)
+    throw invalid_argument("all sizes don't match");
+  double bnorm = sqrt(double(solver_dot(b.data(), b.data(), n)));
+  if (bnorm == 0.0) {
+    T* px = x.data();
+    for (size_t i = 0; i < n; i++)
+      px[i] = T();
+  }
+  return bnorm;
+}
+
+// Память под историю до начала итераций, чтобы solver_record ее не перевыделял
+inline void solver_reserve_history(TSolverReport& rep, const TSolverOptions& opt)
+{
+  if (opt.record_history)
+    rep.history.reserve(min(opt.max_iterations, SOLVER_HISTORY_RESERVE));
+}
+
+// Учет очередной итерации, начатой в момент start
+inline void solver_record(TSolverReport& rep, const TSolverOptions& opt, double residual,
+                          chrono::steady_clock::time_point start)
+{
+  rep.iterations++;
+  rep.residual = residual;
+  if (residual <= opt.tolerance)
+    rep.converged = true;
+  if (opt.record_history) {
+    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    rep.history.push_back({ rep.iterations, residual, sec });
+  }
+}
+
+// Тождественный предобусловливатель: z = r. Методы распознают его при
+// компиляции и не выполняют для него ни копирований, ни лишних проходов
+template<typename T>
+class TIdentityPreconditioner
+{
+  size_t n;
+public:
+  explicit TIdentityPreconditioner(size_t size) : n(size) {}
+
+  void apply(const T* r, T* z) const
+  {
+    copy(r, r + n, z);
+  }
+
+  size_t size() const noexcept { return n; }
+};
+
+// Предобусловливатель - любой класс с методом apply(const T* r, T* z) const,
+// вычисляющим z = M^{-1} r (TJacobiPreconditioner, TILU0Preconditioner, ...)
+template<class P, typename T, typename = void>
+struct is_preconditioner : false_type {};
+
+template<class P, typename T>
+struct is_preconditioner<P, T, void_t<decltype(declval<const P&>().apply(declval<const T*>(), declval<T*>()))>>
+  : true_type {};
+
+template<class P, typename T>
+using enable_if_preconditioner_t = enable_if_t<is_preconditioner<P, T>::value, int>;
+
+// Метод сопряженных градиентов для систем с симметричной положительно
+// определенной матрицей и симметричным положительно определенным
+// предобусловливателем m. x - начальное приближение, в него же записывается
+// решение. Matrix - любая матрица с методом multiply(const T* x, T* y) const
+// (TCSRMatrix, TSymmetricBandMatrix). Невязка в отчете - истинная ||b - Ax|| / ||b||.
+// Итерация состоит из умножения на матрицу и трех проходов по векторам:
+// (p, q); x += alpha p, r -= alpha q вместе с (r, r); p = z + beta p.
+// Предобусловливатель добавляет применение m и проход для (r, z). Невязка
+// на итерациях - рекуррентная; когда она достигает tolerance, r заменяется
+// истинной невязкой b - Ax (еще одно умножение на матрицу), и сходимость
+// решается по ней
+template<typename T, class Matrix, class Precond, enable_if_preconditioner_t<Precond, T> = 0>
+TSolverReport cg(const Matrix& a, const TDynamicVector<T>& b, TDynamicVector<T>& x, const Precond& m,
+                 const TSolverOptions& opt = TSolverOptions())
+{
+  constexpr bool identity = is_same<Precond, TIdentityPreconditioner<T>>::value;
+  TSolverReport rep;
+  double bnorm = solver_prepare(a, b, x);
+  if (bnorm == 0.0) {
+    rep.converged = true;
+    return rep;
+  }
+  size_t n = x.size();
+  const long long sn = (long long)n;
+  const bool par = n >= SOLVER_PARALLEL_SIZE;
+  vector<T> r(n), p(n), q(n), z(identity ? 0 : n);
+  T* px = x.data();
+  const T* pb = b.data();
+  T* pr = r.data();
+  T* pp = p.data();
+  T* pq = q.data();
+  T* pz = identity ? pr : z.data();
+
+  // r = b - Ax, z = M^{-1} r, p = z
+  a.multiply(px, pq);
+  T rr = T();
+#pragma omp parallel for schedule(static) reduction(+:rr) if (par)
+  for (long long i = 0; i < sn; i++) {
+    pr[i] = pb[i] - pq[i];
+    rr += pr[i] * pr[i];
+  }
+  rep.residual = sqrt(double(rr)) / bnorm;
+  if (rep.residual <= opt.tolerance) {
+    rep.converged = true;
+    return rep;
+  }
+  T rz = rr;
+  if (!identity) {
+    m.apply(pr, pz);
+    rz = solver_dot(pr, pz, n);
+  }
+  copy(pz, pz + n, pp);
+
+  solver_reserve_history(rep, opt);
+  while (rep.iterations < opt.max_iterations) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    a.multiply(pp, pq);
+    T pap = solver_dot(pp, pq, n);
+    if (!(pap > T())) {
+      rep.breakdown = true;   // матрица не является положительно определенной
+      break;
+    }
+    T alpha = rz / pap;
+    T rr_new = T();
+#pragma omp parallel for schedule(static) reduction(+:rr_new) if (par)
+    for (long long i = 0; i < sn; i++) {
+      px[i] += alpha * pp[i];
+      pr[i] -= alpha * pq[i];
+      rr_new += pr[i] * pr[i];
+    }
+    double res = sqrt(double(rr_new)) / bnorm;
+    if (res <= opt.tolerance) {
+      // рекуррентная невязка из-за округлений может быть меньше истинной
+      a.multiply(px, pq);
+      rr_new = T();
+#pragma omp parallel for schedule(static) reduction(+:rr_new) if (par)
+      for (long long i = 0; i < sn; i++) {
+        pr[i] = pb[i] - pq[i];
+        rr_new += pr[i] * pr[i];
+      }
+      res = sqrt(double(rr_new)) / bnorm;
+    }
+    if (res > opt.tolerance) {
+      T rz_new = rr_new;
+      if (!identity) {
+        m.apply(pr, pz);
+        rz_new = solver_dot(pr, pz, n);
+      }
+      T beta = rz_new / rz;
+#pragma omp parallel for schedule(static) if (par)
+      for (long long i = 0; i < sn; i++)
+        pp[i] = pz[i] + beta * pp[i];
+      rz = rz_new;
+    }
+    solver_record(rep, opt, res, start);
+    if (rep.converged)
+      break;
+  }
+  return rep;
+}
+
+template<typename T, class Matrix>
+TSolverReport cg(const Matrix& a, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+                 const TSolverOptions& opt = TSolverOptions())
+{
+  return cg(a, b, x, TIdentityPreconditioner<T>(x.size()), opt);
+}
+
+// Стабилизированный метод бисопряженных градиентов (BiCGStab) с правым
+// предобусловливанием для систем с несимметричной матрицей.
+// x - начальное приближение и результат. Все векторы берутся из рабочей
+// области ws, в итерациях память не выделяется.
+// Итерация: два умножения на матрицу и пять проходов по векторам; пары
+// скалярных произведений (t, s), (t, t) и (r, r), (r0, r) считаются вместе
+template<typename T, class Matrix, class Precond, enable_if_preconditioner_t<Precond, T> = 0>
+TSolverReport bicgstab(const Matrix& a, const TDynamicVector<T>& b, TDynamicVector<T>& x, const Precond& m,
+                       TKrylovWorkspace<T>& ws, const TSolverOptions& opt = TSolverOptions())
+{
+  constexpr bool identity = is_same<Precond, TIdentityPreconditioner<T>>::value;
+  TSolverReport rep;
+  double bnorm = solver_prepare(a, b, x);
+  if (bnorm == 0.0) {
+    rep.converged = true;
+    return rep;
+  }
+  size_t n = x.size();
+  const long long sn = (long long)n;
+  const bool par = n >= SOLVER_PARALLEL_SIZE;
+  ws.reserve(n, identity ? 5 : 7);
+  T* px = x.data();
+  const T* pb = b.data();
+  T* r = ws.vec(0);     // невязка; на полушаге в ней же хранится s
+  T* r0 = ws.vec(1);    // теневая невязка
+  T* p = ws.vec(2);
+  T* v = ws.vec(3);
+  T* t = ws.vec(4);
+  T* ph = identity ? p : ws.vec(5);   // M^{-1} p
+  T* sh = identity ? r : ws.vec(6);   // M^{-1} s
+
+  a.multiply(px, v);
+  T rho = T();
+#pragma omp parallel for schedule(static) reduction(+:rho) if (par)
+  for (long long i = 0; i < sn; i++) {
+    r[i] = pb[i] - v[i];
+    r0[i] = r[i];
+    p[i] = T();
+    v[i] = T();
+    rho += r[i] * r[i];
+  }
+  rep.residual = sqrt(double(rho)) / bnorm;
+  if (rep.residual <= opt.tolerance) {
+    rep.converged = true;
+    return rep;
+  }
+  T alpha = T(1), omega = T(1), rho_old = T(1);
+
+  solver_reserve_history(rep, opt);
+  while (rep.iterations < opt.max_iterations) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (rho == T() || omega == T()) {
+      rep.breakdown = true;
+      break;
+    }
+    T beta = (rho / rho_old) * (alpha / omega);
+#pragma omp parallel for schedule(static) if (par)
+    for (long long i = 0; i < sn; i++)
+      p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    if (!identity)
+      m.apply(p, ph);
+    a.multiply(ph, v);
+    T r0v = solver_dot(r0, v, n);
+    if (r0v == T()) {
+      rep.breakdown = true;
+      break;
+    }
+    alpha = rho / r0v;
+    T ss = T();
+#pragma omp parallel for schedule(static) reduction(+:ss) if (par)
+    for (long long i = 0; i < sn; i++) {
+      r[i] -= alpha * v[i];
+      ss += r[i] * r[i];
+    }
+    double res = sqrt(double(ss)) / bnorm;
+    if (res <= opt.tolerance) {
+#pragma omp parallel for schedule(static) if (par)
+      for (long long i = 0; i < sn; i++)
+        px[i] += alpha * ph[i];
+      solver_record(rep, opt, res, start);
+      break;
+    }
+    if (!identity)
+      m.apply(r, sh);
+    a.multiply(sh, t);
+    T ts = T(), tt = T();
+#pragma omp parallel for schedule(static) reduction(+:ts, tt) if (par)
+    for (long long i = 0; i < sn; i++) {
+      ts += t[i] * r[i];
+      tt += t[i] * t[i];
+    }
+    omega = tt == T() ? T() : ts / tt;
+    T rr = T(), rho_new = T();
+#pragma omp parallel for schedule(static) reduction(+:rr, rho_new) if (par)
+    for (long long i = 0; i < sn; i++) {
+      px[i] += alpha * ph[i] + omega * sh[i];
+      r[i] -= omega * t[i];
+      rr += r[i] * r[i];
+      rho_new += r0[i] * r[i];
+    }
+    rho_old = rho;
+    rho = rho_new;
+    solver_record(rep, opt, sqrt(double(rr)) / bnorm, start);
+    if (rep.converged)
+      break;
+  }
+  return rep;
+}
+
+template<typename T, class Matrix, class Precond, enable_if_preconditioner_t<Precond, T> = 0>
+TSolverReport bicgstab(const Matrix& a, const TDynamicVector<T>& b, TDynamicVector<T>& x, const Precond& m,
+                       const TSolverOptions& opt = TSolverOptions())
+{
+  TKrylovWorkspace<T> ws;
+  return bicgstab(a, b, x, m, ws, opt);
+}
+
+template<typename T, class Matrix>
+TSolverReport bicgstab(const Matrix& a, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+                       TKrylovWorkspace<T>& ws, const TSolverOptions& opt = TSolverOptions())
+{
+  return bicgstab(a, b, x, TIdentityPreconditioner<T>(x.size()), ws, opt);
+}
+
+template<typename T, class Matrix>
+TSolverReport bicgstab(const Matrix& a, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+                       const TSolverOptions& opt = TSolverOptions())
+{
+  TKrylovWorkspace<T> ws;
+  return bicgstab(a, b, x, TIdentityPreconditioner<T>(x.size()), ws, opt);
+}
+
+// Обобщенный метод минимальных невязок с перезапуском GMRES(m) и правым
+// предобусловливанием, m = opt.restart. x - начальное приближение и результат.
+// Базис Крылова, матрица Хессенберга и вращения Гивенса хранятся в рабочей
+// области ws. При правом предобусловливании невязка метода совпадает
+// с истинной невязкой системы.
+// Ортогонализация - классический процесс Грама-Шмидта с повторным проходом:
+// скалярные произведения нового вектора со всем базисом считаются одним
+// пакетом, и на шаге выполняются две редукции вместо j, как в модифицированном
+// процессе. Итерацией считается один шаг Арнольди
+template<typename T, class Matrix, class Precond, enable_if_preconditioner_t<Precond, T> = 0>
+TSolverReport gmres(const Matrix& a, const TDynamicVector<T>& b, TDynamicVector<T>& x, const Precond& mp,
+                    TKrylovWorkspace<T>& ws, const TSolverOptions& opt = TSolverOptions())
+{
+  constexpr bool identity = is_same<Precond, TIdentityPreconditioner<T>>::value;
+  if (opt.restart == 0)
+    throw invalid_argument("GMRES restart length should be greater than zero");
+  TSolverReport rep;
+  double bnorm = solver_prepare(a, b, x);
+  if (bnorm == 0.0) {
+    rep.converged = true;
+    return rep;
+  }
+  size_t n = x.size();
+  const long long sn = (long long)n;
+  const bool par = n >= SOLVER_PARALLEL_SIZE;
+  const size_t m = min(opt.restart, n);
+  const size_t ldh = m + 1;
+  // векторы V_0..V_m и z = M^{-1} V_k; H - (m + 1) x m по столбцам, cs, sn, g, h2
+  ws.reserve(n, identity ? m + 1 : m + 2, ldh * m + 4 * ldh);
+  T* px = x.data();
+  const T* pb = b.data();
+  T* V = ws.vec(0);
+  T* z = identity ? nullptr : ws.vec(m + 1);
+  const size_t ld = ws.stride();
+  T* H = ws.extra();
+  T* cs = H + ldh * m;
+  T* sn_ = cs + ldh;
+  T* g = sn_ + ldh;
+  T* h2 = g + ldh;
+
+  solver_reserve_history(rep, opt);
+  while (rep.iterations < opt.max_iterations) {
+    // V_0 = (b - Ax) / ||b - Ax||
+    a.multiply(px, V);
+    T beta = T();
+#pragma omp parallel for schedule(static) reduction(+:beta) if (par)
+    for (long long i = 0; i < sn; i++) {
+      V[i] = pb[i] - V[i];
+      beta += V[i] * V[i];
+    }
+    beta = sqrt(beta);
+    rep.residual = double(beta) / bnorm;
+    if (rep.residual <= opt.tolerance) {
+      rep.converged = true;
+      break;
+    }
+    const T inv = T(1) / beta;
+#pragma omp parallel for schedule(static) if (par)
+    for (long long i = 0; i < sn; i++)
+      V[i] *= inv;
+    for (size_t i = 0; i < ldh; i++)
+      g[i] = T();
+    g[0] = beta;
+
+    size_t k = 0;
+    while (k < m && rep.iterations < opt.max_iterations) {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      T* w = V + (k + 1) * ld;
+      T* h = H + k * ldh;
+      if (identity)
+        a.multiply(V + k * ld, w);
+      else {
+        mp.apply(V + k * ld, z);
+        a.multiply(z, w);
+      }
+      solver_multi_dot(V, ld, k + 1, w, n, h);
+      solver_multi_axpy(V, ld, k + 1, h, w, n);
+      solver_multi_dot(V, ld, k + 1, w, n, h2);
+      T ww = solver_multi_axpy(V, ld, k + 1, h2, w, n);
+      for (size_t i = 0; i <= k; i++)
+        h[i] += h2[i];
+      T hnext = sqrt(ww);
+      if (hnext != T()) {
+        const T hinv = T(1) / hnext;
+#pragma omp parallel for schedule(static) if (par)
+        for (long long i = 0; i < sn; i++)
+          w[i] *= hinv;
+      }
+      // вращения Гивенса приводят H к верхнетреугольному виду
+      for (size_t i = 0; i < k; i++) {
+        T tmp = cs[i] * h[i] + sn_[i] * h[i + 1];
+        h[i + 1] = -sn_[i] * h[i] + cs[i] * h[i + 1];
+        h[i] = tmp;
+      }
+      T d = sqrt(h[k] * h[k] + hnext * hnext);
+      if (d == T()) {
+        // A z_k лежит в уже построенном подпространстве, и H вырождена:
+        // столбец k не участвует в решении, цикл и метод останавливаются
+        cs[k] = T(1);
+        sn_[k] = T();
+        rep.breakdown = true;
+        solver_record(rep, opt, double(abs(g[k])) / bnorm, start);
+        break;
+      }
+      cs[k] = h[k] / d;
+      sn_[k] = hnext / d;
+      h[k] = d;
+      h[k + 1] = T();
+      g[k + 1] = -sn_[k] * g[k];
+      g[k] = cs[k] * g[k];
+      k++;
+      solver_record(rep, opt, double(abs(g[k])) / bnorm, start);
+      if (rep.converged || hnext == T())
+        break;
+    }
+
+    // y = H^{-1} g (обратный ход, y на месте g)
+    for (size_t i = k; i-- > 0;) {
+      T sum = g[i];
+      for (size_t j = i + 1; j < k; j++)
+        sum -= H[i + j * ldh] * g[j];
+      g[i] = sum / H[i + i * ldh];
+    }
+    for (size_t i = 0; i < k; i++)
+      g[i] = -g[i];
+    if (identity)
+      solver_multi_axpy(V, ld, k, g, px, n);      // x -= V (-y)
+    else {
+      // x += M^{-1} V y; V_0 пересчитывается в начале следующего цикла
+      fill(z, z + n, T());
+      solver_multi_axpy(V, ld, k, g, z, n);
+      mp.apply(z, V);
+#pragma omp parallel for schedule(static) if (par)
+      for (long long i = 0; i < sn; i++)
+        px[i] += V[i];
+    }
+    if (rep.converged || rep.breakdown)
+      break;
+  }
+  return rep;
+}
+
+template<typename T, class Matrix, class Precond, enable_if_preconditioner_t<Precond, T> = 0>
+TSolverReport gmres(const Matrix& a, const TDynamicVector<T>& b, TDynamicVector<T>& x, const Precond& mp,
+                    const TSolverOptions& opt = TSolverOptions())
+{
+  TKrylovWorkspace<T> ws;
+  return gmres(a, b, x, mp, ws, opt);
+}
+
+template<typename T, class Matrix>
+TSolverReport gmres(const Matrix& a, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+                    TKrylovWorkspace<T>& ws, const TSolverOptions& opt = TSolverOptions())
+{
+  return gmres(a, b, x, TIdentityPreconditioner<T>(x.size()), ws, opt);
+}
+
+template<typename T, class Matrix>
+TSolverReport gmres(const Matrix& a, const TDynamicVector<T>& b, TDynamicVector<T>& x,
+                    const TSolverOptions& opt = TSolverOptions())
+{
+  TKrylovWorkspace<T> ws;
+  return gmres(a, b, x, TIdentityPreconditioner<T>(x.size()), ws, opt);
+}
+
+#endif
@@ -0,0 +1,334 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Разреженный вектор и операции, работа которых пропорциональна числу
+// ненулевых элементов, а не длине вектора
+
+#ifndef __SPARSE_VECTOR_H__
+#define __SPARSE_VECTOR_H__
+
+#include "csc_matrix.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+// Во сколько раз одно слияние должно быть короче другого, чтобы
+// скалярное произведение искало его элементы двоичным поиском
+const size_t SPARSE_GALLOP_RATIO = 16;
+// Если результат SpMSpV заполнен больше чем на 1/SPARSE_DENSE_RATIO,
+// индексы собираются просмотром всей длины вместо сортировки
+const size_t SPARSE_DENSE_RATIO = 16;
+
+// Разреженный вектор -
+// номера ненулевых элементов по возрастанию и их значения
+template<typename T>
+class TSparseVector
+{
+  size_t n;
+  TTrackedVector<int> idx;
+  TTrackedVector<T> val;
+public:
+  explicit TSparseVector(size_t size) : n(size)
+  {
+    if (n == 0 || n > size_t(MAX_VECTOR_SIZE))
+      throw out_of_range("Vector size should be greater than zero");
+  }
+  // из готовых массивов; номера должны строго возрастать
+  TSparseVector(size_t size, TTrackedVector<int>&& indices, TTrackedVector<T>&& values) : TSparseVector(size)
+  {
+    if (indices.size() != values.size())
+      throw invalid_argument("sparse arrays sizes don't match");
+    for (size_t k = 0; k < indices.size(); k++)
+      if (indices[k] < 0 || size_t(indices[k]) >= n || (k > 0 && indices[k] <= indices[k - 1]))
+        throw invalid_argument("sparse indices must increase and lie in range");
+    idx = move(indices);
+    val = move(values);
+  }
+  // из плотного вектора; элементы с |v_i| <= drop_tolerance отбрасываются
+  explicit TSparseVector(const TDynamicVector<T>& v, T drop_tolerance = T(0)) : TSparseVector(v.size())
+  {
+    const T* p = v.data();
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++)
+      count += abs(p[i]) > drop_tolerance;
+    idx.reserve(count);
+    val.reserve(count);
+    for (size_t i = 0; i < n; i++)
+      if (abs(p[i]) > drop_tolerance) {
+        idx.push_back(int(i));
+        val.push_back(p[i]);
+      }
+  }
+
+  TDynamicVector<T> to_dense() const
+  {
+    TDynamicVector<T> result(n);
+    T* p = result.data();
+    for (size_t k = 0; k < idx.size(); k++)
+      p[idx[k]] = val[k];
+    return result;
+  }
+
+  size_t size() const noexcept { return n; }
+  size_t non_zeros() const noexcept { return idx.size(); }
+  const int* index_data() const noexcept { return idx.data(); }
+  const T* values_data() const noexcept { return val.data(); }
+
+  // добавление элемента в конец; номер должен быть больше всех имеющихся
+  void push_back(int i, T v)
+  {
+    if (i < 0 || size_t(i) >= n || (!idx.empty() && i <= idx.back()))
+      throw invalid_argument("sparse indices must increase and lie in range");
+    idx.push_back(i);
+    val.push_back(v);
+  }
+  void reserve(size_t count)
+  {
+    idx.reserve(count);
+    val.reserve(count);
+  }
+
+  // элемент по номеру за O(log nnz)
+  T operator[](size_t i) const
+  {
+    if (i >= n)
+      throw out_of_range("Index out of range");
+    auto it = lower_bound(idx.begin(), idx.end(), int(i));
+    return it != idx.end() && *it == int(i) ? val[it - idx.begin()] : T();
+  }
+
+  bool operator==(const TSparseVector& v) const noexcept
+  {
+    return n == v.n && idx == v.idx && val == v.val;
+  }
+  bool operator!=(const TSparseVector& v) const noexcept { return !(*this == v); }
+
+  // Скалярное произведение слиянием номеров за O(nnz1 + nnz2); если один
+  // вектор намного короче, его номера ищутся в другом двоичным поиском
+  T operator*(const TSparseVector& v) const
+  {
+    if (n != v.n)
+      throw invalid_argument("size don't match");
+    const TSparseVector& a = idx.size() <= v.idx.size() ? *this : v;
+    const TSparseVector& b = idx.size() <= v.idx.size() ? v : *this;
+    T sum = T();
+    size_t i = 0, j = 0, na = a.idx.size(), nb = b.idx.size();
+    if (na * SPARSE_GALLOP_RATIO < nb) {
+      auto first = b.idx.begin();
+      for (; i < na; i++) {
+        first = lower_bound(first, b.idx.end(), a.idx[i]);
+        if (first == b.idx.end())
+          break;
+        if (*first == a.idx[i])
+          sum += a.val[i] * b.val[first - b.idx.begin()];
+      }
+      return sum;
+    }
+    while (i < na && j < nb) {
+      if (a.idx[i] < b.idx[j])
+        i++;
+      else if (b.idx[j] < a.idx[i])
+        j++;
+      else
+        sum += a.val[i++] * b.val[j++];
+    }
+    return sum;
+  }
+  // скалярное произведение с плотным вектором за O(nnz)
+  T operator*(const TDynamicVector<T>& v) const
+  {
+    if (n != v.size())
+      throw invalid_argument("size don't match");
+    const T* p = v.data();
+    T sum = T();
+    for (size_t k = 0; k < idx.size(); k++)
+      sum += val[k] * p[idx[k]];
+    return sum;
+  }
+
+  // объем памяти в байтах, массивы - по выделенной емкости
+  size_t memory_bytes() const noexcept
+  {
+    return sizeof(*this) + heap_block_bytes(val.capacity() * sizeof(T), alignof(T))
+        + heap_block_bytes(idx.capacity() * sizeof(int), alignof(int));
+  }
+};
+
+template<typename T>
+T operator*(const TDynamicVector<T>& v, const TSparseVector<T>& s)
+{
+  return s * v;
+}
+
+// y += alpha * x за O(nnz(x))
+template<typename T>
+void axpy(T alpha, const TSparseVector<T>& x, TDynamicVector<T>& y)
+{
+  if (x.size() != y.size())
+    throw invalid_argument("size don't match");
+  T* p = y.data();
+  const int* idx = x.index_data();
+  const T* val = x.values_data();
+  for (size_t k = 0; k < x.non_zeros(); k++)
+    p[idx[k]] += alpha * val[k];
+}
+
+// Рабочая память SpMSpV: плотный накопитель и отметки занятых позиций,
+// список затронутых строк и суммы строк для матрицы в хранении по строкам.
+// Накопитель и отметки после каждого умножения снова нулевые, так что
+// повторные умножения не тратят время на очистку и выделение памяти
+template<typename T>
+class TSpMSpVWorkspace
+{
+  vector<T> acc;
+  vector<char> used;
+  vector<int> list;
+  vector<T> sums;
+  vector<char> hits;
+public:
+  void reserve(size_t n)
+  {
+    if (acc.size() < n) {
+      acc.resize(n, T());
+      used.resize(n, 0);
+    }
+  }
+  // место под суммы и отметки m строк; их значения не сохраняются
+  void reserve_rows(size_t m)
+  {
+    if (sums.size() < m) {
+      sums.resize(m);
+      hits.resize(m);
+    }
+  }
+  T* accumulator() { return acc.data(); }
+  char* marks() { return used.data(); }
+  // пустой список номеров; емкость остается от прошлых умножений
+  vector<int>& touched()
+  {
+    list.clear();
+    return list;
+  }
+  T* row_sums() { return sums.data(); }
+  char* row_marks() { return hits.data(); }
+};
+
+// y = A x для матрицы в хранении по столбцам: в накопитель добавляются
+// только столбцы A с номерами ненулевых x_j, поэтому работа пропорциональна
+// числу затронутых элементов A, а не размерам матрицы
+template<typename T>
+TSparseVector<T> spmspv(const TCSCMatrix<T>& a, const TSparseVector<T>& x, TSpMSpVWorkspace<T>& ws)
+{
+  if (size_t(a.get_cols()) != x.size())
+    throw invalid_argument("all sizes don't match");
+  size_t m = size_t(a.get_rows());
+  ws.reserve(m);
+  T* acc = ws.accumulator();
+  char* used = ws.marks();
+  const int* ptr = a.col_index_data();
+  const int* row = a.row_indices_data();
+  const T* av = a.values_data();
+  const int* xi = x.index_data();
+  const T* xv = x.values_data();
+  vector<int>& touched = ws.touched();
+  for (size_t k = 0; k < x.non_zeros(); k++) {
+    const T xj = xv[k];
+    for (int p = ptr[xi[k]]; p < ptr[xi[k] + 1]; p++) {
+      int i = row[p];
+      if (!used[i]) {
+        used[i] = 1;
+        touched.push_back(i);
+      }
+      acc[i] += av[p] * xj;
+    }
+  }
+  if (touched.size() * SPARSE_DENSE_RATIO > m) {
+    touched.clear();
+    for (size_t i = 0; i < m; i++)
+      if (used[i])
+        touched.push_back(int(i));
+  }
+  else
+    sort(touched.begin(), touched.end());
+  TTrackedVector<int> idx(touched.size());
+  TTrackedVector<T> val(touched.size());
+  for (size_t k = 0; k < touched.size(); k++) {
+    int i = touched[k];
+    idx[k] = i;
+    val[k] = acc[i];
+    acc[i] = T();
+    used[i] = 0;
+  }
+  return TSparseVector<T>(m, move(idx), move(val));
+}
+
+template<typename T>
+TSparseVector<T> operator*(const TCSCMatrix<T>& a, const TSparseVector<T>& x)
+{
+  TSpMSpVWorkspace<T> ws;
+  return spmspv(a, x, ws);
+}
+
+// y = A x для матрицы в хранении по строкам: x раскладывается в плотный
+// накопитель, и каждая строка A умножается на него параллельно. Работа
+// O(nnz(A) + rows); если матрица хранится и по столбцам, быстрее TCSCMatrix
+template<typename T>
+TSparseVector<T> spmspv(const TCSRMatrix<T>& a, const TSparseVector<T>& x, TSpMSpVWorkspace<T>& ws)
+{
+  if (size_t(a.get_cols()) != x.size())
+    throw invalid_argument("all sizes don't match");
+  int m = a.get_rows();
+  ws.reserve(x.size());
+  ws.reserve_rows(size_t(m));
+  T* dense = ws.accumulator();
+  char* used = ws.marks();
+  const int* xi = x.index_data();
+  const T* xv = x.values_data();
+  for (size_t k = 0; k < x.non_zeros(); k++) {
+    dense[xi[k]] = xv[k];
+    used[xi[k]] = 1;
+  }
+  const int* ptr = a.row_index_data();
+  const int* col = a.col_indices_data();
+  const T* av = a.values_data();
+  T* y = ws.row_sums();
+  char* hit = ws.row_marks();
+#pragma omp parallel for schedule(static) if (size_t(a.non_zeros()) >= CSR_SPMV_PARALLEL_SIZE)
+  for (int i = 0; i < m; i++) {
+    T sum = T();
+    char h = 0;
+    for (int p = ptr[i]; p < ptr[i + 1]; p++)
+      if (used[col[p]]) {
+        sum += av[p] * dense[col[p]];
+        h = 1;
+      }
+    y[i] = sum;
+    hit[i] = h;
+  }
+  for (size_t k = 0; k < x.non_zeros(); k++) {
+    dense[xi[k]] = T();
+    used[xi[k]] = 0;
+  }
+  size_t count = 0;
+  for (int i = 0; i < m; i++)
+    count += hit[i];
+  TTrackedVector<int> idx(count);
+  TTrackedVector<T> val(count);
+  for (int i = 0, k = 0; i < m; i++)
+    if (hit[i]) {
+      idx[k] = i;
+      val[k++] = y[i];
+    }
+  return TSparseVector<T>(size_t(m), move(idx), move(val));
+}
+
+template<typename T>
+TSparseVector<T> operator*(const TCSRMatrix<T>& a, const TSparseVector<T>& x)
+{
+  TSpMSpVWorkspace<T> ws;
+  return spmspv(a, x, ws);
+}
+
+#endif
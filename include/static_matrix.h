@@ -0,0 +1,230 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Векторы и матрицы фиксированного размера
+
+#ifndef __STATIC_MATRIX_H__
+#define __STATIC_MATRIX_H__
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+// Вызывает f(0), f(1), ..., f(N - 1) без цикла: тело разворачивается
+// при компиляции независимо от настроек оптимизатора
+template<typename F, size_t... I>
+constexpr void static_unroll_impl(F&& f, index_sequence<I...>)
+{
+  (f(I), ...);
+}
+
+template<size_t N, typename F>
+constexpr void static_unroll(F&& f)
+{
+  static_unroll_impl(f, make_index_sequence<N>());
+}
+
+// Статический вектор -
+// шаблонный вектор фиксированного размера, хранится на стеке.
+// Повторяет интерфейс TDynamicVector, поэтому переход между
+// фиксированным и динамическим размером сводится к замене типа
+template<typename T, size_t N>
+class TStaticVector
+{
+  static_assert(N > 0, "Vector size should be greater than zero");
+protected:
+  T mem[N]{};
+public:
+  constexpr TStaticVector() = default;
+
+  constexpr size_t size() const noexcept { return N; }
+
+  constexpr T* data() noexcept { return mem; }
+  constexpr const T* data() const noexcept { return mem; }
+
+  // индексация
+  constexpr T& operator[](size_t ind) { return mem[ind]; }
+  constexpr const T& operator[](size_t ind) const { return mem[ind]; }
+  // индексация с контролем
+  constexpr T& at(size_t ind)
+  {
+      if (ind >= N)
+          throw out_of_range("Vector index out of range");
+      return mem[ind];
+  }
+  constexpr const T& at(size_t ind) const
+  {
+      if (ind >= N)
+          throw out_of_range("Vector index out of range");
+      return mem[ind];
+  }
+
+  // сравнение
+  constexpr bool operator==(const TStaticVector& v) const noexcept
+  {
+      bool eq = true;
+      static_unroll<N>([&](size_t i) { eq = eq && mem[i] == v.mem[i]; });
+      return eq;
+  }
+  constexpr bool operator!=(const TStaticVector& v) const noexcept
+  {
+      return !(*this == v);
+  }
+
+  // скалярные операции
+  constexpr TStaticVector operator+(T val) const
+  {
+      TStaticVector result;
+      static_unroll<N>([&](size_t i) { result.mem[i] = mem[i] + val; });
+      return result;
+  }
+  constexpr TStaticVector operator-(T val) const
+  {
+      TStaticVector result;
+      static_unroll<N>([&](size_t i) { result.mem[i] = mem[i] - val; });
+      return result;
+  }
+  constexpr TStaticVector operator*(T val) const
+  {
+      TStaticVector result;
+      static_unroll<N>([&](size_t i) { result.mem[i] = mem[i] * val; });
+      return result;
+  }
+
+  // векторные операции; размеры проверяются при компиляции
+  constexpr TStaticVector operator+(const TStaticVector& v) const
+  {
+      TStaticVector result;
+      static_unroll<N>([&](size_t i) { result.mem[i] = mem[i] + v.mem[i]; });
+      return result;
+  }
+  constexpr TStaticVector operator-(const TStaticVector& v) const
+  {
+      TStaticVector result;
+      static_unroll<N>([&](size_t i) { result.mem[i] = mem[i] - v.mem[i]; });
+      return result;
+  }
+  constexpr T operator*(const TStaticVector& v) const
+  {
+      T result = T();
+      static_unroll<N>([&](size_t i) { result += mem[i] * v.mem[i]; });
+      return result;
+  }
+
+  friend void swap(TStaticVector& lhs, TStaticVector& rhs) noexcept
+  {
+    std::swap(lhs.mem, rhs.mem);
+  }
+
+  // ввод/вывод
+  friend istream& operator>>(istream& istr, TStaticVector& v)
+  {
+    for (size_t i = 0; i < N; i++)
+      istr >> v.mem[i];
+    return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TStaticVector& v)
+  {
+    for (size_t i = 0; i < N; i++)
+      ostr << v.mem[i] << ' ';
+    return ostr;
+  }
+};
+
+
+// Статическая матрица -
+// шаблонная матрица R x C фиксированного размера, хранится на стеке
+template<typename T, size_t R, size_t C>
+class TStaticMatrix : public TStaticVector<TStaticVector<T, C>, R>
+{
+  using TStaticVector<TStaticVector<T, C>, R>::mem;
+public:
+  constexpr TStaticMatrix() = default;
+
+  constexpr size_t rows() const noexcept { return R; }
+  constexpr size_t cols() const noexcept { return C; }
+
+  using TStaticVector<TStaticVector<T, C>, R>::operator[];
+
+  // сравнение
+  constexpr bool operator==(const TStaticMatrix& m) const noexcept
+  {
+      bool eq = true;
+      static_unroll<R>([&](size_t i) { eq = eq && mem[i] == m.mem[i]; });
+      return eq;
+  }
+  constexpr bool operator!=(const TStaticMatrix& m) const noexcept
+  {
+      return !(*this == m);
+  }
+
+  // матрично-скалярные операции
+  constexpr TStaticMatrix operator*(const T& val) const
+  {
+      TStaticMatrix result;
+      static_unroll<R>([&](size_t i) { result[i] = mem[i] * val; });
+      return result;
+  }
+
+  // матрично-векторные операции
+  constexpr TStaticVector<T, R> operator*(const TStaticVector<T, C>& v) const
+  {
+      TStaticVector<T, R> result;
+      static_unroll<R>([&](size_t i) { result[i] = mem[i] * v; });
+      return result;
+  }
+
+  // матрично-матричные операции
+  constexpr TStaticMatrix operator+(const TStaticMatrix& m) const
+  {
+      TStaticMatrix result;
+      static_unroll<R>([&](size_t i) { result[i] = mem[i] + m.mem[i]; });
+      return result;
+  }
+  constexpr TStaticMatrix operator-(const TStaticMatrix& m) const
+  {
+      TStaticMatrix result;
+      static_unroll<R>([&](size_t i) { result[i] = mem[i] - m.mem[i]; });
+      return result;
+  }
+  template<size_t K>
+  constexpr TStaticMatrix<T, R, K> operator*(const TStaticMatrix<T, C, K>& m) const
+  {
+      TStaticMatrix<T, R, K> result;
+      static_unroll<R>([&](size_t i) {
+          static_unroll<C>([&](size_t k) {
+              static_unroll<K>([&](size_t j) { result[i][j] += mem[i][k] * m[k][j]; });
+          });
+      });
+      return result;
+  }
+
+  constexpr TStaticMatrix<T, C, R> transpose() const
+  {
+      TStaticMatrix<T, C, R> result;
+      static_unroll<R>([&](size_t i) {
+          static_unroll<C>([&](size_t j) { result[j][i] = mem[i][j]; });
+      });
+      return result;
+  }
+
+  // ввод/вывод
+  friend istream& operator>>(istream& istr, TStaticMatrix& v)
+  {
+      for (size_t i = 0; i < R; i++)
+          istr >> v.mem[i];
+      return istr;
+  }
+  friend ostream& operator<<(ostream& ostr, const TStaticMatrix& v)
+  {
+      for (size_t i = 0; i < R; i++) {
+          for (size_t j = 0; j < C; j++)
+              ostr << v.mem[i][j] << ' ';
+          ostr << endl;
+      }
+      return ostr;
+  }
+};
+
+#endif
@@ -0,0 +1,154 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Умножение больших плотных матриц по схеме Штрассена-Винограда
+
+#ifndef __STRASSEN_H__
+#define __STRASSEN_H__
+
+#include "tmatrix.h"
+#include <vector>
+
+// Порог, ниже которого рекурсия переходит на блочное классическое умножение
+const size_t STRASSEN_CUTOFF = 256;
+
+// Z = X + Y и Z = X - Y для квадратных блоков h x h с шагами строк ldx, ldy, ldz
+template<typename T>
+void strassen_add(size_t h, const T* x, size_t ldx, const T* y, size_t ldy, T* z, size_t ldz)
+{
+  for (size_t i = 0; i < h; i++)
+    for (size_t j = 0; j < h; j++)
+      z[i * ldz + j] = x[i * ldx + j] + y[i * ldy + j];
+}
+
+template<typename T>
+void strassen_sub(size_t h, const T* x, size_t ldx, const T* y, size_t ldy, T* z, size_t ldz)
+{
+  for (size_t i = 0; i < h; i++)
+    for (size_t j = 0; j < h; j++)
+      z[i * ldz + j] = x[i * ldx + j] - y[i * ldy + j];
+}
+
+// Размер рабочего буфера для рекурсии: на каждом уровне нужны два временных
+// блока половинного размера, нечетные размеры обрабатываются отсечением
+// последней строки и столбца
+inline size_t strassen_workspace(size_t n, size_t cutoff)
+{
+  if (n <= cutoff)
+    return 0;
+  if (n % 2 == 1)
+    return strassen_workspace(n - 1, cutoff);
+  size_t h = n / 2;
+  return 2 * h * h + strassen_workspace(h, cutoff);
+}
+
+// C = A * B для квадратных матриц n x n в непрерывных буферах с шагами lda, ldb, ldc.
+// work - рабочий буфер размера strassen_workspace(n, cutoff)
+template<typename T>
+void strassen_rec(size_t n, const T* a, size_t lda, const T* b, size_t ldb,
+                  T* c, size_t ldc, T* work, size_t cutoff)
+{
+  if (n <= cutoff) {
+    for (size_t i = 0; i < n; i++)
+      fill(c + i * ldc, c + i * ldc + n, T());
+    gemm_blocked<T>(n, n, n,
+        [a, lda](size_t i) { return a + i * lda; },
+        [b, ldb](size_t k) { return b + k * ldb; },
+        [c, ldc](size_t i) { return c + i * ldc; });
+    return;
+  }
+
+  if (n % 2 == 1) {
+    // отсекаем последнюю строку и столбец: A = [A11 a12; a21 a22]
+    size_t m = n - 1;
+    strassen_rec(m, a, lda, b, ldb, c, ldc, work, cutoff);
+    const T* a12 = a + m;            // столбец, шаг lda
+    const T* a21 = a + m * lda;      // строка
+    const T* b12 = b + m;            // столбец, шаг ldb
+    const T* b21 = b + m * ldb;      // строка
+    T* c21 = c + m * ldc;
+    // C11 += a12 * b21, c12 = A11 * b12 + a12 * b22
+    for (size_t i = 0; i < m; i++) {
+      T* ci = c + i * ldc;
+      const T* ai = a + i * lda;
+      const T ai_m = a12[i * lda];
+      T s = ai_m * b12[m * ldb];
+      for (size_t j = 0; j < m; j++) {
+        ci[j] += ai_m * b21[j];
+        s += ai[j] * b12[j * ldb];
+      }
+      ci[m] = s;
+    }
+    // c21 = a21 * B11 + a22 * b21, c22 = a21 * b12 + a22 * b22
+    const T a22 = a21[m];
+    for (size_t j = 0; j < n; j++)
+      c21[j] = a22 * b21[j];
+    for (size_t k = 0; k < m; k++) {
+      const T ak = a21[k];
+      const T* bk = b + k * ldb;
+      for (size_t j = 0; j < n; j++)
+        c21[j] += ak * bk[j];
+    }
+    return;
+  }
+
+  size_t h = n / 2;
+  const T *a11 = a, *a12 = a + h, *a21 = a + h * lda, *a22 = a + h * lda + h;
+  const T *b11 = b, *b12 = b + h, *b21 = b + h * ldb, *b22 = b + h * ldb + h;
+  T *c11 = c, *c12 = c + h, *c21 = c + h * ldc, *c22 = c + h * ldc + h;
+  T* x = work;
+  T* y = work + h * h;
+  T* next = work + 2 * h * h;
+
+  // расписание Дугласа и др.: 7 умножений, 15 сложений, два временных блока
+  strassen_sub(h, a11, lda, a21, lda, x, h);           // S3 = A11 - A21
+  strassen_sub(h, b22, ldb, b12, ldb, y, h);           // T3 = B22 - B12
+  strassen_rec(h, x, h, y, h, c21, ldc, next, cutoff); // P7 = S3 * T3
+  strassen_add(h, a21, lda, a22, lda, x, h);           // S1 = A21 + A22
+  strassen_sub(h, b12, ldb, b11, ldb, y, h);           // T1 = B12 - B11
+  strassen_rec(h, x, h, y, h, c22, ldc, next, cutoff); // P5 = S1 * T1
+  strassen_sub(h, x, h, a11, lda, x, h);               // S2 = S1 - A11
+  strassen_sub(h, b22, ldb, y, h, y, h);               // T2 = B22 - T1
+  strassen_rec(h, x, h, y, h, c12, ldc, next, cutoff); // P6 = S2 * T2
+  strassen_sub(h, a12, lda, x, h, x, h);               // S4 = A12 - S2
+  strassen_rec(h, x, h, b22, ldb, c11, ldc, next, cutoff); // P3 = S4 * B22
+  strassen_rec(h, a11, lda, b11, ldb, x, h, next, cutoff); // P1 = A11 * B11
+  strassen_add(h, x, h, c12, ldc, c12, ldc);           // U2 = P1 + P6
+  strassen_add(h, c12, ldc, c21, ldc, c21, ldc);       // U3 = U2 + P7
+  strassen_add(h, c12, ldc, c22, ldc, c12, ldc);       // U4 = U2 + P5
+  strassen_add(h, c21, ldc, c22, ldc, c22, ldc);       // C22 = U3 + P5
+  strassen_add(h, c12, ldc, c11, ldc, c12, ldc);       // C12 = U4 + P3
+  strassen_sub(h, y, h, b21, ldb, y, h);               // T4 = T2 - B21
+  strassen_rec(h, a22, lda, y, h, c11, ldc, next, cutoff); // P4 = A22 * T4
+  strassen_sub(h, c21, ldc, c11, ldc, c21, ldc);       // C21 = U3 - P4
+  strassen_rec(h, a12, lda, b21, ldb, c11, ldc, next, cutoff); // P2 = A12 * B21
+  strassen_add(h, x, h, c11, ldc, c11, ldc);           // C11 = P1 + P2
+}
+
+// Умножение матриц по схеме Штрассена-Винограда. Имеет смысл для n порядка
+// нескольких тысяч; при n <= cutoff совпадает с обычным блочным умножением.
+// Матрицы упаковываются в непрерывные буферы, рабочая память выделяется один раз
+template<typename T>
+TDynamicMatrix<T> strassen_multiply(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b,
+                                    size_t cutoff = STRASSEN_CUTOFF)
+{
+  size_t n = a.size();
+  if (n != b.size())
+    throw invalid_argument("matrix size don't match");
+  if (cutoff == 0)
+    throw invalid_argument("strassen cutoff should be greater than zero");
+
+  vector<T> pa(n * n), pb(n * n), pc(n * n);
+  for (size_t i = 0; i < n; i++) {
+    copy(a[i].data(), a[i].data() + n, pa.data() + i * n);
+    copy(b[i].data(), b[i].data() + n, pb.data() + i * n);
+  }
+  vector<T> work(strassen_workspace(n, cutoff));
+  strassen_rec(n, pa.data(), n, pb.data(), n, pc.data(), n, work.data(), cutoff);
+
+  TDynamicMatrix<T> result(n);
+  for (size_t i = 0; i < n; i++)
+    copy(pc.data() + i * n, pc.data() + (i + 1) * n, result[i].data());
+  return result;
+}
+
+#endif
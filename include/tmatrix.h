@@ -8,63 +8,417 @@
 #define __TDynamicMatrix_H__
 
 #include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "instrument.h"
+#include "int_gemm.h"
 
 using namespace std;
 
 const int MAX_VECTOR_SIZE = 100000000;
 const int MAX_MATRIX_SIZE = 10000;
 
+// Размеры блоков для умножения матриц: блок строк B высотой GEMM_BLOCK_K
+// и шириной GEMM_BLOCK_N должен помещаться в кэш L2
+const size_t GEMM_BLOCK_K = 64;
+const size_t GEMM_BLOCK_N = 256;
+
+// Блочное умножение C += A * B, где A - m x p, B - p x n.
+// Строки задаются функциями a(i), b(k), c(i), возвращающими указатель на
+// начало строки, поэтому ядро подходит и для построчно хранимой матрицы,
+// и для непрерывного буфера с заданным шагом
+template<typename T, typename RowA, typename RowB, typename RowC>
+void gemm_blocked(size_t m, size_t n, size_t p, RowA a, RowB b, RowC c)
+{
+  for (size_t kk = 0; kk < p; kk += GEMM_BLOCK_K) {
+    size_t kend = min(kk + GEMM_BLOCK_K, p);
+    for (size_t jj = 0; jj < n; jj += GEMM_BLOCK_N) {
+      size_t jend = min(jj + GEMM_BLOCK_N, n);
+      for (size_t i = 0; i < m; i++) {
+        T* ci = c(i);
+        const T* ai = a(i);
+        for (size_t k = kk; k < kend; k++) {
+          const T aik = ai[k];
+          const T* bk = b(k);
+          for (size_t j = jj; j < jend; j++)
+            ci[j] += aik * bk[j];
+        }
+      }
+    }
+  }
+}
+
+// Блочное умножение C += A^T * B без построения A^T: a(k) возвращает
+// k-ю строку A, так что элемент (i, k) матрицы A^T - это a(k)[i]
+template<typename T, typename RowA, typename RowB, typename RowC>
+void gemm_blocked_tn(size_t m, size_t n, size_t p, RowA a, RowB b, RowC c)
+{
+  for (size_t kk = 0; kk < p; kk += GEMM_BLOCK_K) {
+    size_t kend = min(kk + GEMM_BLOCK_K, p);
+    for (size_t jj = 0; jj < n; jj += GEMM_BLOCK_N) {
+      size_t jend = min(jj + GEMM_BLOCK_N, n);
+      for (size_t i = 0; i < m; i++) {
+        T* ci = c(i);
+        for (size_t k = kk; k < kend; k++) {
+          const T aki = a(k)[i];
+          const T* bk = b(k);
+          for (size_t j = jj; j < jend; j++)
+            ci[j] += aki * bk[j];
+        }
+      }
+    }
+  }
+}
+
+// Скалярное произведение n элементов x[0], x[incx], ... и y[0], y[incy], ...
+// с накоплением в Acc. Вход по указателю и шагу - общий для векторов и
+// представлений (matrix_view.h): строка, отрезок вектора и часть строки
+// передаются сюда без копирования
+template<typename Acc, typename T, typename U>
+Acc dot_strided(size_t n, const T* x, ptrdiff_t incx, const U* y, ptrdiff_t incy)
+{
+  Acc sum = Acc();
+  if (incx == 1 && incy == 1) {
+    for (size_t i = 0; i < n; i++)
+      sum += Acc(x[i]) * Acc(y[i]);
+    return sum;
+  }
+  for (size_t i = 0; i < n; i++)
+    sum += Acc(x[ptrdiff_t(i) * incx]) * Acc(y[ptrdiff_t(i) * incy]);
+  return sum;
+}
+
+// y = A x для матрицы m x n, строки которой задает a(i), как в gemm_blocked;
+// x и y - массивы с шагами incx и incy
+template<typename Acc, typename RowA, typename U>
+void gemv_strided(size_t m, size_t n, RowA a, const U* x, ptrdiff_t incx, Acc* y, ptrdiff_t incy)
+{
+  for (size_t i = 0; i < m; i++)
+    y[ptrdiff_t(i) * incy] = dot_strided<Acc>(n, a(i), 1, x, incx);
+}
+
+// Режим хранения вектора или матрицы. Owned - у объекта всегда свой буфер.
+// CopyOnWrite - копия разделяет буфер с оригиналом, а отдельный буфер
+// получает только при первом изменении. Счетчик ссылок буфера атомарный,
+// поэтому разделяемые копии можно использовать из разных потоков.
+// Режим задается для каждого объекта (set_storage) и переходит к копиям;
+// в режиме Owned доступ к элементам не обращается к счетчику ссылок.
+// Пока на буфер могут указывать выданные data() или ссылки на строки
+// матрицы, копии получают свой буфер; share() снова разрешает разделение,
+// когда эти указатели больше не используются
+enum class TStorage { Owned, CopyOnWrite };
+
+// Размер блока из bytes байт в куче вместе со служебными данными
+// распределителя. Оценка для malloc из glibc: к блоку добавляется слово
+// с его размером, итог округляется до двух слов и не меньше четырех слов;
+// при выравнивании сильнее стандартного добавляется запас на сдвиг начала
+inline size_t heap_block_bytes(size_t bytes, size_t align = alignof(max_align_t))
+{
+  if (bytes == 0)
+    return 0;
+  const size_t granule = 2 * sizeof(size_t);
+  size_t block = max((bytes + sizeof(size_t) + granule - 1) / granule * granule, 2 * granule);
+  if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    block += align;
+  return block;
+}
+
+// Объем кучи, занятый сейчас векторами и матрицами библиотеки, с учетом
+// служебных данных распределителя
+inline atomic<size_t>& live_bytes_counter()
+{
+  static atomic<size_t> bytes(0);
+  return bytes;
+}
+inline size_t library_live_bytes() { return live_bytes_counter().load(memory_order_relaxed); }
+
+// Распределитель для std::vector в классах библиотеки: память учитывается
+// в library_live_bytes и в счетчиках TMATRIX_INSTRUMENT
+template<typename T>
+struct TTrackingAllocator
+{
+  using value_type = T;
+
+  TTrackingAllocator() noexcept = default;
+  template<typename U>
+  TTrackingAllocator(const TTrackingAllocator<U>&) noexcept {}
+
+  T* allocate(size_t n)
+  {
+    T* p = allocator<T>().allocate(n);
+    TMATRIX_ALLOC(n * sizeof(T));
+    live_bytes_counter().fetch_add(heap_block_bytes(n * sizeof(T), alignof(T)), memory_order_relaxed);
+    return p;
+  }
+  void deallocate(T* p, size_t n) noexcept
+  {
+    live_bytes_counter().fetch_sub(heap_block_bytes(n * sizeof(T), alignof(T)), memory_order_relaxed);
+    allocator<T>().deallocate(p, n);
+  }
+
+  template<typename U>
+  bool operator==(const TTrackingAllocator<U>&) const noexcept { return true; }
+  template<typename U>
+  bool operator!=(const TTrackingAllocator<U>&) const noexcept { return false; }
+};
+
+template<typename T>
+using TTrackedVector = vector<T, TTrackingAllocator<T>>;
+
+template<typename T>
+class TDynamicVector;
+
+// Память в куче, принадлежащая элементу вектора (для строк матрицы - их буферы)
+template<typename T>
+size_t owned_heap_bytes(const T&) noexcept { return 0; }
+template<typename T>
+size_t owned_heap_bytes(const TDynamicVector<T>& v) noexcept;
+
+template<typename T>
+class TDynamicMatrix;
+
 // Динамический вектор - 
 // шаблонный вектор на динамической памяти
 template<typename T>
 class TDynamicVector
 {
+  // транспонирование на месте меняет строки через их буферы
+  friend class TDynamicMatrix<T>;
 protected:
   size_t sz;
   T* pMem;
+  TStorage mode = TStorage::Owned;
+
+  // Перед элементами буфера хранится счетчик ссылок на него. Буфер, на
+  // элементы которого выданы неконстантные ссылки или указатели, не
+  // разделяется до share(): иначе запись по такой ссылке изменила бы и копию
+  struct TBufferHeader
+  {
+    atomic<size_t> refs;
+    atomic<bool> shareable;
+  };
+  static constexpr size_t buffer_align = alignof(T) > alignof(TBufferHeader) ? alignof(T) : alignof(TBufferHeader);
+  static constexpr size_t header_size = (sizeof(TBufferHeader) + buffer_align - 1) / buffer_align * buffer_align;
+
+  static TBufferHeader* header(T* p)
+  {
+    return reinterpret_cast<TBufferHeader*>(reinterpret_cast<char*>(p) - header_size);
+  }
+  // буфер на n элементов со счетчиком ссылок, равным 1; элементы не создаются
+  static T* allocate(size_t n)
+  {
+    if (n > (numeric_limits<size_t>::max() - header_size) / sizeof(T))
+      throw bad_array_new_length();
+    TMATRIX_ALLOC(header_size + n * sizeof(T));
+    live_bytes_counter().fetch_add(heap_block_bytes(header_size + n * sizeof(T), buffer_align), memory_order_relaxed);
+    char* raw = static_cast<char*>(::operator new(header_size + n * sizeof(T), align_val_t(buffer_align)));
+    new (raw) TBufferHeader{ {1}, {true} };
+    return reinterpret_cast<T*>(raw + header_size);
+  }
+  static void deallocate(T* p, size_t n)
+  {
+    header(p)->~TBufferHeader();
+    live_bytes_counter().fetch_sub(heap_block_bytes(header_size + n * sizeof(T), buffer_align), memory_order_relaxed);
+    ::operator delete(reinterpret_cast<char*>(p) - header_size, align_val_t(buffer_align));
+  }
+  static T* create_value(size_t n)
+  {
+    T* p = allocate(n);
+    try {
+      uninitialized_value_construct_n(p, n); // У типа T д.б. констуктор по умолчанию
+    }
+    catch (...) {
+      deallocate(p, n);
+      throw;
+    }
+    return p;
+  }
+  static T* create_copy(const T* src, size_t n)
+  {
+    T* p = allocate(n);
+    try {
+      uninitialized_copy_n(src, n, p);
+    }
+    catch (...) {
+      deallocate(p, n);
+      throw;
+    }
+    return p;
+  }
+  // буфер, i-й элемент которого создается из make(i)
+  template<typename Make>
+  static T* create_from(size_t n, Make make)
+  {
+    T* p = allocate(n);
+    size_t i = 0;
+    try {
+      for (; i < n; i++)
+        ::new (static_cast<void*>(p + i)) T(make(i));
+    }
+    catch (...) {
+      destroy_n(p, i);
+      deallocate(p, n);
+      throw;
+    }
+    return p;
+  }
+  // отказ от ссылки на буфер; последняя ссылка уничтожает элементы
+  static void release(T* p, size_t n)
+  {
+    if (p != nullptr && header(p)->refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+      destroy_n(p, n);
+      deallocate(p, n);
+    }
+  }
+  // копия буфера v: общая в режиме CopyOnWrite, если на элементы v не
+  // выдавались ссылки для записи, иначе собственная
+  static T* copy_buffer(const TDynamicVector& v)
+  {
+    if (v.pMem != nullptr && v.mode == TStorage::CopyOnWrite && header(v.pMem)->shareable.load(memory_order_relaxed)) {
+      header(v.pMem)->refs.fetch_add(1, memory_order_relaxed);
+      return v.pMem;
+    }
+    return create_copy(v.pMem, v.sz);
+  }
+  // буфер вместе со счетчиком ссылок и память, принадлежащая элементам
+  size_t heap_bytes() const noexcept
+  {
+    if (pMem == nullptr)
+      return 0;
+    size_t bytes = heap_block_bytes(header_size + sz * sizeof(T), buffer_align);
+    if constexpr (!is_arithmetic_v<T>)
+      for (size_t i = 0; i < sz; i++)
+        bytes += owned_heap_bytes(pMem[i]);
+    return bytes;
+  }
+  // перед изменением элементов вектор получает собственный буфер;
+  // в режиме Owned буфер всегда собственный и проверять нечего
+  void detach()
+  {
+    if (mode == TStorage::CopyOnWrite && pMem != nullptr && header(pMem)->refs.load(memory_order_acquire) != 1) {
+      T* p = create_copy(pMem, sz);
+      release(pMem, sz);
+      pMem = p;
+    }
+  }
+  // перед выдачей неконстантной ссылки или указателя: собственный буфер,
+  // который не разделяется до вызова share()
+  void detach_for_write()
+  {
+    if (mode == TStorage::CopyOnWrite) {
+      detach();
+      if (pMem != nullptr)
+        header(pMem)->shareable.store(false, memory_order_relaxed);
+    }
+  }
+  // вектор с элементами make(i): строки матрицы создаются сразу нужной
+  // длины, без промежуточных векторов по умолчанию
+  struct TFromMaker {};
+  template<typename Make>
+  TDynamicVector(TFromMaker, size_t size, Make make) : sz(size)
+  {
+    if (sz == 0)
+      throw out_of_range("Vector size should be greater than zero");
+    pMem = create_from(sz, make);
+  }
 public:
+  // ссылка на элемент числового вектора: чтение идет прямо из буфера, а
+  // запись сначала отделяет буфер (detach). Поэтому в режиме CopyOnWrite
+  // чтение через неконстантный вектор не копирует общий буфер, а ссылка,
+  // полученная до копирования вектора, не меняет копию
+  class TElementRef
+  {
+    TDynamicVector* v;
+    size_t ind;
+    T& target()
+    {
+      v->detach();
+      return v->pMem[ind];
+    }
+  public:
+    TElementRef(TDynamicVector* vec, size_t i) noexcept : v(vec), ind(i) {}
+    TElementRef(const TElementRef&) = default;
+    operator T() const noexcept { return v->pMem[ind]; }
+    TElementRef& operator=(const TElementRef& r) { return *this = T(r); }
+    TElementRef& operator=(T val) { target() = val; return *this; }
+    TElementRef& operator+=(T val) { target() += val; return *this; }
+    TElementRef& operator-=(T val) { target() -= val; return *this; }
+    TElementRef& operator*=(T val) { target() *= val; return *this; }
+    TElementRef& operator/=(T val) { target() /= val; return *this; }
+    TElementRef& operator++() { ++target(); return *this; }
+    TElementRef& operator--() { --target(); return *this; }
+    T operator++(int) { return target()++; }
+    T operator--(int) { return target()--; }
+    friend void swap(TElementRef a, TElementRef b)
+    {
+      T tmp = a;
+      a = T(b);
+      b = tmp;
+    }
+    friend istream& operator>>(istream& istr, TElementRef r)
+    {
+      T val;
+      if (istr >> val)
+        r = val;
+      return istr;
+    }
+    friend ostream& operator<<(ostream& ostr, const TElementRef& r)
+    {
+      return ostr << T(r);
+    }
+  };
+  // неконстантная индексация: у числовых векторов - TElementRef, у
+  // векторов векторов (строки матрицы) - обычная ссылка
+  using reference = conditional_t<is_arithmetic_v<T>, TElementRef, T&>;
+
   TDynamicVector(size_t size = 1) : sz(size)
   {
     if (sz == 0)
       throw out_of_range("Vector size should be greater than zero");
-    pMem = new T[sz]();// {}; // У типа T д.б. констуктор по умолчанию
+    pMem = create_value(sz);
   }
   TDynamicVector(T* arr, size_t s) : sz(s)
   {
     assert(arr != nullptr && "TDynamicVector ctor requires non-nullptr arg");
-    pMem = new T[sz];
-    std::copy(arr, arr + sz, pMem);
+    pMem = create_copy(arr, sz);
   }
   TDynamicVector(const TDynamicVector& v)
   {
       sz = v.sz;
-      pMem = new T[sz];
-      for (size_t i = 0; i < sz; i++) {
-          pMem[i] = v.pMem[i];
-      }
+      pMem = copy_buffer(v);
+      mode = v.mode;
   }
   TDynamicVector(TDynamicVector&& v) noexcept
   {
       pMem = v.pMem;
       sz = v.sz;
+      mode = v.mode;
       v.pMem = nullptr;
       v.sz = 0;
   }
   ~TDynamicVector()
   {
-      delete[]pMem;
+      release(pMem, sz);
   }
   TDynamicVector& operator=(const TDynamicVector& v)
   {
       if (this == &v) {
           return *this;
       }
-      delete[]pMem;
+      T* p = copy_buffer(v);
+      release(pMem, sz);
       sz = v.sz;
-      pMem = new T[sz];
-      for (size_t i = 0; i < sz; i++) {
-          pMem[i] = v.pMem[i];
-      }
+      pMem = p;
+      mode = v.mode;
       return *this; //возвращаем ссылку на текущий объект
   }
   TDynamicVector& operator=(TDynamicVector&& v) noexcept 
@@ -72,32 +426,69 @@ public:
       if (this == &v) {
           return *this;
       }
-      delete[]pMem;
+      release(pMem, sz);
       sz = v.sz;
       pMem = v.pMem;
+      mode = v.mode;
       v.pMem = nullptr;
       v.sz = 0;
       return *this;
   }
 
   size_t size() const noexcept { return sz; }
+  // Объем памяти в байтах: сам объект, буфер со служебными данными
+  // распределителя и буферы элементов (у матрицы - строки). Буфер, общий
+  // для нескольких копий в режиме CopyOnWrite, учитывается у каждой
+  size_t memory_bytes() const noexcept { return sizeof(*this) + heap_bytes(); }
+
+  // режим хранения; копии получают режим оригинала
+  TStorage storage() const noexcept { return mode; }
+  // при переходе в CopyOnWrite буфер не разделяется до share(): на него
+  // могут указывать ссылки, выданные раньше
+  void set_storage(TStorage m)
+  {
+      detach();
+      if (m == TStorage::CopyOnWrite && mode != m && pMem != nullptr)
+          header(pMem)->shareable.store(false, memory_order_relaxed);
+      mode = m;
+  }
+  // разрешает копиям разделять буфер; вызывается, когда выданные data()
+  // и ссылки на строки больше не используются
+  void share() noexcept
+  {
+      if (pMem != nullptr)
+          header(pMem)->shareable.store(true, memory_order_relaxed);
+  }
+
+  // доступ к непрерывному буферу элементов
+  T* data()
+  {
+      detach_for_write();
+      return pMem;
+  }
+  const T* data() const noexcept { return pMem; }
 
   // индексация
-  T& operator[](size_t ind)
+  reference operator[](size_t ind)
   {
-      return pMem[ind];
+      if constexpr (is_arithmetic_v<T>)
+          return TElementRef(this, ind);
+      else {
+          detach_for_write();
+          return pMem[ind];
+      }
   }
   const T& operator[](size_t ind) const
   {
       return pMem[ind];
   }
   // индексация с контролем
-  T& at(size_t ind)
+  reference at(size_t ind)
   {
       if (ind >= sz) {
           throw "out of range";
       }
-      return pMem[ind];
+      return (*this)[ind];
   }
   const T& at(size_t ind) const
   {
@@ -127,6 +518,7 @@ public:
   // скалярные операции
   TDynamicVector operator+(T val)
   {
+      TMATRIX_OP(VectorScalar, sz, sz * sizeof(T), sz * sizeof(T));
       TDynamicVector result(sz);
       //к результирующему добавлем val
       for (size_t i = 0; i < sz; i++) {
@@ -136,6 +528,7 @@ public:
   }
   TDynamicVector operator-(T val)
   {
+      TMATRIX_OP(VectorScalar, sz, sz * sizeof(T), sz * sizeof(T));
       TDynamicVector result(sz);
       for (size_t i = 0; i < sz; i++) {
           result.pMem[i] = pMem[i] - val;
@@ -144,6 +537,7 @@ public:
   }
   TDynamicVector operator*(T val)
   {
+      TMATRIX_OP(VectorScalar, sz, sz * sizeof(T), sz * sizeof(T));
       TDynamicVector result(sz);
       for (size_t i = 0; i < sz; i++) {
           result.pMem[i] = pMem[i] * val;
@@ -157,6 +551,7 @@ public:
       if (sz != v.sz) {
           throw "size don't match";
       }
+      TMATRIX_OP(VectorAdd, sz, 2 * sz * sizeof(T), sz * sizeof(T));
       TDynamicVector result(sz);
       for (size_t i = 0; i < sz; i++) {
           result.pMem[i] = pMem[i] + v.pMem[i];
@@ -167,31 +562,39 @@ public:
   {
       if (sz != v.sz)
           throw "size don't match";
+      TMATRIX_OP(VectorAdd, sz, 2 * sz * sizeof(T), sz * sizeof(T));
       TDynamicVector result(sz);
       for (size_t i = 0; i < sz; i++) {
           result.pMem[i] = pMem[i] - v.pMem[i];
       }
       return result;
   }
-  T operator*(const TDynamicVector& v) noexcept(noexcept(T()))
+  T operator*(const TDynamicVector& v)
+  {
+      return dot<T>(v);
+  }
+  // скалярное произведение с накоплением в типе Acc: элементы хранятся в T
+  // (например, float), а сумма копится в более точном Acc (например, double)
+  template<typename Acc = T>
+  Acc dot(const TDynamicVector& v) const
   {
       if (sz != v.sz)
           throw "size don't match";
-      T result = T();                      //инициализация значением по умолч
-      for (size_t i = 0; i < sz; i++)
-          result += pMem[i] * v.pMem[i];
-      return result;
+      TMATRIX_OP(VectorDot, 2 * sz, 2 * sz * sizeof(T), 0);
+      return dot_strided<Acc>(sz, pMem, 1, v.pMem, 1);
   }
 
   friend void swap(TDynamicVector& lhs, TDynamicVector& rhs) noexcept
   {
     std::swap(lhs.sz, rhs.sz);
     std::swap(lhs.pMem, rhs.pMem);
+    std::swap(lhs.mode, rhs.mode);
   }
 
   // ввод/вывод
   friend istream& operator>>(istream& istr, TDynamicVector& v)
   {
+    v.detach();
     for (size_t i = 0; i < v.sz; i++)
       istr >> v.pMem[i]; // требуется оператор>> для типа T
     return istr;
@@ -204,6 +607,12 @@ public:
   }
 };
 
+template<typename T>
+size_t owned_heap_bytes(const TDynamicVector<T>& v) noexcept
+{
+  return v.memory_bytes() - sizeof(v);
+}
+
 
 // Динамическая матрица - 
 // шаблонная матрица на динамической памяти
@@ -212,11 +621,96 @@ class TDynamicMatrix : public TDynamicVector<TDynamicVector<T>>
 {
   using TDynamicVector<TDynamicVector<T>>::pMem;
   using TDynamicVector<TDynamicVector<T>>::sz;
+
+  // Транспонирование рекурсивно делит матрицу пополам по большей стороне,
+  // пока блок не станет меньше TRANSPOSE_TILE x TRANSPOSE_TILE: такой блок
+  // источника и приемника помещается в кэш на любом его уровне
+  static const size_t TRANSPOSE_TILE = 32;
+
+  // dst[j][i] = src[i][j] для i из [r0, r1), j из [c0, c1)
+  static void transpose_rec(const TDynamicMatrix& src, TDynamicMatrix& dst,
+                            size_t r0, size_t r1, size_t c0, size_t c1)
+  {
+      size_t h = r1 - r0, w = c1 - c0;
+      if (h <= TRANSPOSE_TILE && w <= TRANSPOSE_TILE) {
+          for (size_t i = r0; i < r1; i++) {
+              const T* s = as_const(src.pMem[i]).data();
+              for (size_t j = c0; j < c1; j++)
+                  dst.pMem[j][i] = s[j];
+          }
+          return;
+      }
+      if (h >= w) {
+          size_t rm = r0 + h / 2;
+          transpose_rec(src, dst, r0, rm, c0, c1);
+          transpose_rec(src, dst, rm, r1, c0, c1);
+      }
+      else {
+          size_t cm = c0 + w / 2;
+          transpose_rec(src, dst, r0, r1, c0, cm);
+          transpose_rec(src, dst, r0, r1, cm, c1);
+      }
+  }
+
+  // обмен блока [r0, r1) x [c0, c1) с симметричным ему блоком [c0, c1) x [r0, r1)
+  void transpose_swap_rec(size_t r0, size_t r1, size_t c0, size_t c1)
+  {
+      size_t h = r1 - r0, w = c1 - c0;
+      if (h <= TRANSPOSE_TILE && w <= TRANSPOSE_TILE) {
+          for (size_t i = r0; i < r1; i++) {
+              T* s = pMem[i].pMem;
+              for (size_t j = c0; j < c1; j++)
+                  std::swap(s[j], pMem[j].pMem[i]);
+          }
+          return;
+      }
+      if (h >= w) {
+          size_t rm = r0 + h / 2;
+          transpose_swap_rec(r0, rm, c0, c1);
+          transpose_swap_rec(rm, r1, c0, c1);
+      }
+      else {
+          size_t cm = c0 + w / 2;
+          transpose_swap_rec(r0, r1, c0, cm);
+          transpose_swap_rec(r0, r1, cm, c1);
+      }
+  }
+
+  // транспонирование диагонального блока [d0, d1) x [d0, d1) на месте
+  void transpose_diag_rec(size_t d0, size_t d1)
+  {
+      if (d1 - d0 <= TRANSPOSE_TILE) {
+          for (size_t i = d0; i < d1; i++) {
+              T* s = pMem[i].pMem;
+              for (size_t j = i + 1; j < d1; j++)
+                  std::swap(s[j], pMem[j].pMem[i]);
+          }
+          return;
+      }
+      size_t dm = d0 + (d1 - d0) / 2;
+      transpose_diag_rec(d0, dm);
+      transpose_diag_rec(dm, d1);
+      transpose_swap_rec(d0, dm, dm, d1);
+  }
 public:
-  TDynamicMatrix(size_t s = 1) : TDynamicVector<TDynamicVector<T>>(s)
+  TDynamicMatrix(size_t s = 1)
+    : TDynamicVector<TDynamicVector<T>>(typename TDynamicVector<TDynamicVector<T>>::TFromMaker(), s,
+                                        [s](size_t) { return TDynamicVector<T>(s); })
+  {
+  }
+
+  // режим хранения задается и массиву строк, и каждой строке
+  void set_storage(TStorage m)
+  {
+      TDynamicVector<TDynamicVector<T>>::set_storage(m);
+      for (size_t i = 0; i < sz; i++)
+          pMem[i].set_storage(m);
+  }
+  void share() noexcept
   {
-    for (size_t i = 0; i < sz; i++)
-      pMem[i] = TDynamicVector<T>(sz);
+      TDynamicVector<TDynamicVector<T>>::share();
+      for (size_t i = 0; i < sz; i++)
+          pMem[i].share();
   }
 
   using TDynamicVector<TDynamicVector<T>>::operator[];
@@ -238,6 +732,7 @@ public:
   // матрично-скалярные операции
   TDynamicMatrix operator*(const T& val)
   {
+      TMATRIX_OP(MatrixScalar, sz * sz, sz * sz * sizeof(T), sz * sz * sizeof(T));
       TDynamicMatrix result(sz);
       for (size_t i = 0; i < sz; i++) {
           result[i] = pMem[i] * val; //каждую строку умнож на число
@@ -247,16 +742,26 @@ public:
 
   // матрично-векторные операции
   TDynamicVector<T> operator*(const TDynamicVector<T>& v)
+  {
+      return multiply<T>(v);
+  }
+  // y = A * x с накоплением сумм строк в типе Acc; x - массив длины sz,
+  // y - массив Acc длины sz. При хранении в float и накоплении в double
+  // из памяти читается вдвое меньше, а точность сумм - как у double
+  template<typename Acc>
+  void multiply(const T* x, Acc* y) const
+  {
+      TMATRIX_OP(MatrixVector, 2 * sz * sz, (sz * sz + sz) * sizeof(T), sz * sizeof(Acc));
+      gemv_strided(sz, sz, [this](size_t i) { return as_const(pMem[i]).data(); }, x, 1, y, 1);
+  }
+  template<typename Acc>
+  TDynamicVector<Acc> multiply(const TDynamicVector<T>& v) const
   {
       if (sz != v.size()) {
           throw invalid_argument("all sizes don't match");
       }
-      TDynamicVector<T> result(sz);
-      for (size_t i = 0; i < sz; i++) {
-          result[i] = T();
-          for (size_t j = 0; j < sz; j++)
-              result[i] += pMem[i][j] * v[j];
-      }
+      TDynamicVector<Acc> result(sz);
+      multiply(v.data(), result.data());
       return result;
   }
 
@@ -266,6 +771,7 @@ public:
       if (sz != m.sz) {
           throw "matrix size don't match";
       }
+      TMATRIX_OP(MatrixAdd, sz * sz, 2 * sz * sz * sizeof(T), sz * sz * sizeof(T));
       TDynamicMatrix result(sz);
       for (size_t i = 0; i < sz; i++) {
           result[i] = pMem[i] + m.pMem[i];
@@ -277,6 +783,7 @@ public:
       if (sz != m.sz) {
           throw "matrix size don't match";
       }
+      TMATRIX_OP(MatrixAdd, sz * sz, 2 * sz * sz * sizeof(T), sz * sz * sizeof(T));
       TDynamicMatrix result(sz);
       for (size_t i = 0; i < sz; i++) {
           result[i] = pMem[i] - m.pMem[i];
@@ -288,21 +795,42 @@ public:
       if (sz != m.sz) {
           throw "matrix size don't match";
       }
-      TDynamicMatrix result(sz);
-      for (size_t i = 0; i < sz; i++) {
-          for (size_t j = 0; j < sz; j++) {
-              result[i][j] = T();                //обнуляем элемент результата
-              for (size_t k = 0; k < sz; k++) {
-                  result[i][j] += pMem[i][k] * m.pMem[k][j];
-              }
-          }
+      TMATRIX_OP(MatrixMultiply, 2 * sz * sz * sz, 2 * sz * sz * sizeof(T), sz * sz * sizeof(T));
+      TDynamicMatrix result(sz); // элементы результата уже обнулены
+      auto a_row = [this](size_t i) { return as_const(pMem[i]).data(); };
+      auto b_row = [&m](size_t k) { return as_const(m.pMem[k]).data(); };
+      auto c_row = [&result](size_t i) { return result.pMem[i].data(); };
+      // целые, умещающиеся в int8, uint8 или int16, умножаются векторным
+      // ядром с накоплением в int32; проверка диапазона стоит O(sz^2)
+      if constexpr (INT_GEMM_SIMD && is_same<T, int32_t>::value) {
+          if (gemm_int_narrowed(sz, sz, sz, int_range(sz, sz, a_row), int_range(sz, sz, b_row), a_row, b_row, c_row))
+              return result;
       }
+      gemm_blocked<T>(sz, sz, sz, a_row, b_row, c_row);
+      return result;
+  }
+
+  // транспонирование
+  TDynamicMatrix transpose() const
+  {
+      TMATRIX_OP(MatrixTranspose, 0, sz * sz * sizeof(T), sz * sz * sizeof(T));
+      TDynamicMatrix result(sz);
+      transpose_rec(*this, result, 0, sz, 0, sz);
       return result;
   }
+  void transpose_inplace()
+  {
+      TMATRIX_OP(MatrixTranspose, 0, sz * sz * sizeof(T), sz * sz * sizeof(T));
+      this->detach();
+      for (size_t i = 0; i < sz; i++)
+          pMem[i].detach();
+      transpose_diag_rec(0, sz);
+  }
 
   // ввод/вывод
   friend istream& operator>>(istream& istr, TDynamicMatrix& v)
   {
+      v.detach();
       for (size_t i = 0; i < v.sz; i++) {
           istr >> v.pMem[i];
       }
@@ -312,7 +840,7 @@ public:
   {
       for (size_t i = 0; i < v.sz; i++) {
           for (size_t j = 0; j < v.sz; j++) {
-              ostr << v.pMem[i][j] << ' ';
+              ostr << as_const(v.pMem[i])[j] << ' ';
           }
           ostr << endl;
       }
@@ -320,4 +848,105 @@ public:
   }
 };
 
+// Признак транспонирования: transposed(A) не копирует матрицу, а только
+// помечает ее, и операции умножения сами выбирают порядок обхода, читающий
+// A на месте. Признак хранит ссылку и должен использоваться в том же выражении
+template<typename M>
+struct TTransposed
+{
+  const M& m;
+};
+
+template<typename M>
+TTransposed<M> transposed(const M& m)
+{
+  return TTransposed<M>{ m };
+}
+
+// A^T * B: строки A и B читаются подряд
+template<typename T>
+TDynamicMatrix<T> operator*(const TTransposed<TDynamicMatrix<T>>& at, const TDynamicMatrix<T>& b)
+{
+  const TDynamicMatrix<T>& a = at.m;
+  size_t n = a.size();
+  if (n != b.size())
+    throw invalid_argument("matrix size don't match");
+  TMATRIX_OP(MatrixMultiply, 2 * n * n * n, 2 * n * n * sizeof(T), n * n * sizeof(T));
+  TDynamicMatrix<T> result(n);
+  gemm_blocked_tn<T>(n, n, n,
+      [&a](size_t k) { return a[k].data(); },
+      [&b](size_t k) { return b[k].data(); },
+      [&result](size_t i) { return result[i].data(); });
+  return result;
+}
+
+// A * B^T: элемент результата - скалярное произведение строк A и B.
+// Блоки строк обеих матриц и отрезки по k подбираются под кэш
+template<typename T>
+TDynamicMatrix<T> operator*(const TDynamicMatrix<T>& a, const TTransposed<TDynamicMatrix<T>>& bt)
+{
+  const TDynamicMatrix<T>& b = bt.m;
+  size_t n = a.size();
+  if (n != b.size())
+    throw invalid_argument("matrix size don't match");
+  TMATRIX_OP(MatrixMultiply, 2 * n * n * n, 2 * n * n * sizeof(T), n * n * sizeof(T));
+  const size_t rb = 32;
+  TDynamicMatrix<T> result(n);
+  for (size_t kk = 0; kk < n; kk += GEMM_BLOCK_N) {
+    size_t kend = min(kk + GEMM_BLOCK_N, n);
+    for (size_t ii = 0; ii < n; ii += rb)
+      for (size_t jj = 0; jj < n; jj += rb)
+        for (size_t i = ii; i < min(ii + rb, n); i++) {
+          const T* ai = a[i].data();
+          T* ci = result[i].data();
+          for (size_t j = jj; j < min(jj + rb, n); j++) {
+            const T* bj = b[j].data();
+            T s = T();
+            for (size_t k = kk; k < kend; k++)
+              s += ai[k] * bj[k];
+            ci[j] += s;
+          }
+        }
+  }
+  return result;
+}
+
+// C = A * B для матриц из int8, uint8 или int16: произведения копятся
+// и возвращаются в int32, поэтому не переполняют узкий тип
+template<typename TA, typename TB>
+TDynamicMatrix<int32_t> multiply_i32(const TDynamicMatrix<TA>& a, const TDynamicMatrix<TB>& b)
+{
+  static_assert(is_narrow_int<TA>::value && is_narrow_int<TB>::value, "int8, uint8 or int16 expected");
+  size_t n = a.size();
+  if (n != b.size())
+    throw invalid_argument("matrix size don't match");
+  TMATRIX_OP(MatrixMultiply, 2 * n * n * n, n * n * (sizeof(TA) + sizeof(TB)), n * n * sizeof(int32_t));
+  TDynamicMatrix<int32_t> result(n);
+  gemm_int<TA, TB>(n, n, n,
+      [&a](size_t i) { return a[i].data(); },
+      [&b](size_t k) { return b[k].data(); },
+      [&result](size_t i) { return result[i].data(); });
+  return result;
+}
+
+// A^T * x: сумма строк A с коэффициентами x[k]
+template<typename T>
+TDynamicVector<T> operator*(const TTransposed<TDynamicMatrix<T>>& at, const TDynamicVector<T>& x)
+{
+  const TDynamicMatrix<T>& a = at.m;
+  size_t n = a.size();
+  if (n != x.size())
+    throw invalid_argument("all sizes don't match");
+  TMATRIX_OP(MatrixVector, 2 * n * n, (n * n + n) * sizeof(T), n * sizeof(T));
+  TDynamicVector<T> result(n);
+  T* y = result.data();
+  for (size_t k = 0; k < n; k++) {
+    const T xk = x[k];
+    const T* ak = a[k].data();
+    for (size_t i = 0; i < n; i++)
+      y[i] += xk * ak[i];
+  }
+  return result;
+}
+
 #endif
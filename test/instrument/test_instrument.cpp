@@ -0,0 +1,111 @@
+// Собирается в отдельную программу с определенным TMATRIX_INSTRUMENT
+#include "dop_matrix.h"
+
+#include <gtest.h>
+#include <sstream>
+
+TEST(instrument, counts_vector_addition)
+{
+	TDynamicVector<double> a(100), b(100);
+	instrument_reset();
+	TDynamicVector<double> c = a + b;
+	TOpCounters k = instrument_counters(TMatrixOp::VectorAdd);
+	EXPECT_EQ(1, k.calls);
+	EXPECT_EQ(100, k.flops);
+	EXPECT_EQ(1600, k.bytes_read);
+	EXPECT_EQ(800, k.bytes_written);
+	EXPECT_EQ(1, k.allocations);
+	EXPECT_LE(800, k.bytes_allocated);
+}
+
+TEST(instrument, counts_dot_product_without_allocations)
+{
+	TDynamicVector<double> a(50), b(50);
+	instrument_reset();
+	a * b;
+	a * b;
+	TOpCounters k = instrument_counters(TMatrixOp::VectorDot);
+	EXPECT_EQ(2, k.calls);
+	EXPECT_EQ(200, k.flops);
+	EXPECT_EQ(0, k.bytes_written);
+	EXPECT_EQ(0, k.allocations);
+}
+
+TEST(instrument, attributes_row_operations_to_matrix_operation)
+{
+	TDynamicMatrix<double> a(10), b(10);
+	instrument_reset();
+	TDynamicMatrix<double> c = a + b;
+	TOpCounters add = instrument_counters(TMatrixOp::MatrixAdd);
+	EXPECT_EQ(1, add.calls);
+	EXPECT_EQ(100, add.flops);
+	// массив строк результата, его строки и суммы строк
+	EXPECT_EQ(1 + 10 + 10, add.allocations);
+	EXPECT_EQ(0, instrument_counters(TMatrixOp::VectorAdd).calls);
+	EXPECT_EQ(0, instrument_counters(TMatrixOp::Other).allocations);
+}
+
+TEST(instrument, counts_matrix_multiplication)
+{
+	TDynamicMatrix<double> a(20), b(20);
+	instrument_reset();
+	TDynamicMatrix<double> c = a * b;
+	TOpCounters k = instrument_counters(TMatrixOp::MatrixMultiply);
+	EXPECT_EQ(1, k.calls);
+	EXPECT_EQ(2 * 20 * 20 * 20, k.flops);
+	EXPECT_EQ(2 * 20 * 20 * sizeof(double), k.bytes_read);
+	EXPECT_EQ(20 * 20 * sizeof(double), k.bytes_written);
+}
+
+TEST(instrument, counts_band_matrix_vector_product)
+{
+	TGeneralBandMatrix<double> a(10, 1, 1);
+	TDynamicVector<double> x(10);
+	instrument_reset();
+	TDynamicVector<double> y = a * x;
+	TOpCounters k = instrument_counters(TMatrixOp::BandVector);
+	EXPECT_EQ(1, k.calls);
+	EXPECT_EQ(2 * (9 + 10 + 9), k.flops);
+	EXPECT_EQ(10 * sizeof(double), k.bytes_written);
+}
+
+TEST(instrument, counts_csr_operations)
+{
+	TCSRMatrix<double> a(4, 4);
+	instrument_reset();
+	for (int i = 0; i < 4; i++)
+		a.set(i, i, 2.0);
+	a.set(0, 3, 1.0);
+	EXPECT_EQ(5, instrument_counters(TMatrixOp::CSRSet).calls);
+	TDynamicVector<double> x(4);
+	TDynamicVector<double> y = a * x;
+	TOpCounters k = instrument_counters(TMatrixOp::CSRVector);
+	EXPECT_EQ(1, k.calls);
+	EXPECT_EQ(2 * 5, k.flops);
+	TCSRMatrix<double> c = a * a;
+	// на каждый ненулевой a_ik приходится строка k второго множителя:
+	// a_00 - две, a_03, a_11, a_22, a_33 - по одной
+	EXPECT_EQ(2 * (2 + 1 + 1 + 1 + 1), instrument_counters(TMatrixOp::CSRMultiply).flops);
+}
+
+TEST(instrument, reset_clears_counters)
+{
+	TDynamicVector<double> a(10);
+	a = a * 2.0;
+	instrument_reset();
+	TOpCounters k = instrument_counters(TMatrixOp::VectorScalar);
+	EXPECT_EQ(0, k.calls);
+	EXPECT_EQ(0, k.allocations);
+	EXPECT_EQ(0.0, k.seconds);
+}
+
+TEST(instrument, report_lists_performed_operations)
+{
+	TDynamicVector<double> a(10), b(10);
+	instrument_reset();
+	a - b;
+	ostringstream out;
+	instrument_report(out);
+	EXPECT_NE(string::npos, out.str().find("vector_add"));
+	EXPECT_EQ(string::npos, out.str().find("matrix_multiply"));
+}
@@ -0,0 +1,105 @@
+#include "batch_matrix.h"
+
+#include <gtest.h>
+
+static TMatrixBatch<double> make_test_batch(size_t count, size_t n)
+{
+	TMatrixBatch<double> a(count, n);
+	for (size_t b = 0; b < count; b++)
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = 0; j < n; j++)
+				a(b, i, j) = (i == j ? n + 1.0 : 0.0) + double((b + 3 * i + 5 * j) % 7) - 3.0;
+	return a;
+}
+
+TEST(TMatrixBatch, can_create_batch)
+{
+	ASSERT_NO_THROW(TMatrixBatch<double> a(10, 3));
+}
+
+TEST(TMatrixBatch, throws_when_create_empty_batch)
+{
+	ASSERT_ANY_THROW(TMatrixBatch<double> a(0, 3));
+}
+
+TEST(TMatrixBatch, stores_elements_of_each_matrix_separately)
+{
+	TMatrixBatch<int> a(3, 2);
+	a(1, 0, 1) = 5;
+	EXPECT_EQ(5, a(1, 0, 1));
+	EXPECT_EQ(0, a(0, 0, 1));
+	EXPECT_EQ(0, a(2, 0, 1));
+}
+
+TEST(TMatrixBatch, batch_gemm_multiplies_each_matrix)
+{
+	const size_t count = 300, n = 3;
+	TMatrixBatch<double> a = make_test_batch(count, n), b = make_test_batch(count, n), c(count, n);
+	batch_gemm(a, b, c);
+	for (size_t l = 0; l < count; l++)
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = 0; j < n; j++) {
+				double s = 0;
+				for (size_t k = 0; k < n; k++)
+					s += a(l, i, k) * b(l, k, j);
+				EXPECT_DOUBLE_EQ(s, c(l, i, j));
+			}
+}
+
+TEST(TMatrixBatch, batch_gemv_multiplies_each_matrix_by_vector)
+{
+	TMatrixBatch<int> a(2, 2), x(2, 2, 1), y(2, 2, 1);
+	a(0, 0, 0) = 1; a(0, 0, 1) = 2; a(0, 1, 0) = 3; a(0, 1, 1) = 4;
+	a(1, 0, 0) = 2; a(1, 1, 1) = 2;
+	x(0, 0, 0) = 2; x(0, 1, 0) = 3;
+	x(1, 0, 0) = 5; x(1, 1, 0) = 7;
+	batch_gemv(a, x, y);
+	EXPECT_EQ(8, y(0, 0, 0));
+	EXPECT_EQ(18, y(0, 1, 0));
+	EXPECT_EQ(10, y(1, 0, 0));
+	EXPECT_EQ(14, y(1, 1, 0));
+}
+
+TEST(TMatrixBatch, batch_solve_finds_solution)
+{
+	const size_t count = 513, n = 4;
+	TMatrixBatch<double> a = make_test_batch(count, n), x(count, n, 1), rhs(count, n, 1);
+	for (size_t l = 0; l < count; l++)
+		for (size_t i = 0; i < n; i++)
+			x(l, i, 0) = double(i + l % 5);
+	batch_gemv(a, x, rhs);
+	TMatrixBatch<double> res = batch_solve(a, rhs);
+	for (size_t l = 0; l < count; l++)
+		for (size_t i = 0; i < n; i++)
+			EXPECT_NEAR(x(l, i, 0), res(l, i, 0), 1e-9);
+}
+
+TEST(TMatrixBatch, batch_lu_pivots_on_zero_diagonal)
+{
+	TMatrixBatch<double> a(1, 2), rhs(1, 2, 1);
+	a(0, 0, 1) = 1; a(0, 1, 0) = 2;
+	rhs(0, 0, 0) = 3; rhs(0, 1, 0) = 4;
+	TMatrixBatch<double> x = batch_solve(a, rhs);
+	EXPECT_DOUBLE_EQ(2.0, x(0, 0, 0));
+	EXPECT_DOUBLE_EQ(3.0, x(0, 1, 0));
+}
+
+TEST(TMatrixBatch, batch_lu_counts_singular_matrices)
+{
+	TMatrixBatch<double> a = make_test_batch(4, 3);
+	for (size_t j = 0; j < 3; j++)
+		a(2, 1, j) = a(2, 0, j);
+	vector<size_t> piv;
+	EXPECT_EQ(1, batch_lu(a, piv));
+}
+
+TEST(TMatrixBatch, batch_inverse_gives_identity_product)
+{
+	const size_t count = 50, n = 3;
+	TMatrixBatch<double> a = make_test_batch(count, n), c(count, n);
+	batch_gemm(a, batch_inverse(a), c);
+	for (size_t l = 0; l < count; l++)
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = 0; j < n; j++)
+				EXPECT_NEAR(i == j ? 1.0 : 0.0, c(l, i, j), 1e-12);
+}
@@ -0,0 +1,161 @@
+#include "bsr_matrix.h"
+#include "test_helpers.h"
+
+#include <gtest.h>
+
+// Матрица из блоков b x b на блочной трехдиагонали; в блоках есть нули,
+// а элементы строк добавляются в обратном порядке
+static TCSRMatrix<double> make_block_tridiagonal(int blocks, int b)
+{
+	int n = blocks * b;
+	TCSRMatrix<double> a(n, n);
+	for (int i = n - 1; i >= 0; i--)
+		for (int j = n - 1; j >= 0; j--) {
+			int bi = i / b, bj = j / b;
+			if (abs(bi - bj) <= 1 && (i + 2 * j) % 5 != 0)
+				a.set(i, j, double((i * 3 + j) % 7) - 3.0 + (i == j ? 10.0 : 0.0));
+		}
+	return a;
+}
+
+TEST(TBSRMatrix, groups_elements_into_blocks)
+{
+	TCSRMatrix<double> a = make_block_tridiagonal(5, 3);
+	TBSRMatrix<double, 3> m(a);
+	EXPECT_EQ(5 + 2 * 4, m.non_zero_blocks());
+	for (int i = 0; i < 15; i++)
+		for (int j = 0; j < 15; j++)
+			EXPECT_EQ(a(i, j), m(i, j));
+}
+
+TEST(TBSRMatrix, orders_blocks_by_column)
+{
+	TBSRMatrix<double, 3> m(make_block_tridiagonal(6, 3));
+	for (int bi = 0; bi < m.get_block_rows(); bi++)
+		for (int k = m.block_index_data()[bi] + 1; k < m.block_index_data()[bi + 1]; k++)
+			EXPECT_LT(m.block_cols_data()[k - 1], m.block_cols_data()[k]);
+}
+
+TEST(TBSRMatrix, multiplies_by_vector_with_3x3_blocks)
+{
+	TCSRMatrix<double> a = make_block_tridiagonal(20, 3);
+	TBSRMatrix<double, 3> m(a);
+	TDynamicVector<double> x = make_x(60), y = a * x, z = m * x;
+	for (int i = 0; i < 60; i++)
+		EXPECT_NEAR(y[i], z[i], 1e-12);
+}
+
+TEST(TBSRMatrix, multiplies_by_vector_with_6x6_blocks)
+{
+	TCSRMatrix<double> a = make_block_tridiagonal(10, 6);
+	TBSRMatrix<double, 6> m(a);
+	TDynamicVector<double> x = make_x(60), y = a * x, z = m * x;
+	for (int i = 0; i < 60; i++)
+		EXPECT_NEAR(y[i], z[i], 1e-12);
+}
+
+TEST(TBSRMatrix, multiplies_by_dense_matrix)
+{
+	// 30 столбцов: три полосы по BSR_SPMM_WIDTH и остаток
+	TCSRMatrix<double> a = make_block_tridiagonal(5, 6);
+	TBSRMatrix<double, 6> m(a);
+	TDynamicMatrix<double> x(30);
+	for (int i = 0; i < 30; i++)
+		for (int j = 0; j < 30; j++)
+			x[i][j] = double((i + 3 * j) % 7) - 3.0;
+	TDynamicMatrix<double> y = m * x;
+	for (int j = 0; j < 30; j++) {
+		TDynamicVector<double> col(30);
+		for (int i = 0; i < 30; i++)
+			col[i] = x[i][j];
+		TDynamicVector<double> expected = a * col;
+		for (int i = 0; i < 30; i++)
+			EXPECT_NEAR(expected[i], y[i][j], 1e-12);
+	}
+}
+
+TEST(TBSRMatrix, converts_back_to_csr_without_padding_zeros)
+{
+	TCSRMatrix<double> a = make_block_tridiagonal(4, 3);
+	TCSRMatrix<double> b = TBSRMatrix<double, 3>(a).to_csr();
+	EXPECT_EQ(a.non_zeros(), b.non_zeros());
+	EXPECT_EQ(a.to_dense(), b.to_dense());
+}
+
+// Матрица из mb блочных строк по b строк: в блочной строке bi блоки
+// bi - 1, bi, bi + 1 и дальний блок (bi * 37 + 5) % mb; в блоках есть нули,
+// а столбцы строки идут в обратном порядке. Массивы CSR строятся напрямую,
+// чтобы не вставлять элементы по одному
+static TCSRMatrix<double> make_wide_block_matrix(int mb, int b)
+{
+	int n = mb * b;
+	TTrackedVector<int> ptr(1, 0), col;
+	TTrackedVector<double> val;
+	for (int i = 0; i < n; i++) {
+		int bi = i / b;
+		vector<int> blocks = { bi - 1, bi, bi + 1, (bi * 37 + 5) % mb };
+		sort(blocks.begin(), blocks.end());
+		blocks.erase(unique(blocks.begin(), blocks.end()), blocks.end());
+		for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
+			if (*it < 0 || *it >= mb)
+				continue;
+			for (int j = (*it + 1) * b - 1; j >= *it * b; j--)
+				if ((i + 2 * j) % 5 != 0) {
+					col.push_back(j);
+					val.push_back(1.0 + double((i * 3 + j) % 7));
+				}
+		}
+		ptr.push_back(int(col.size()));
+	}
+	return TCSRMatrix<double>(n, n, move(ptr), move(col), move(val));
+}
+
+TEST(TBSRMatrix, converts_and_multiplies_in_parallel)
+{
+	// блочных строк не меньше BSR_PARALLEL_SIZE: параллельны и подсчет
+	// блоков с отметками mark, и раскладка по slot, и оба умножения
+	const int mb = int(BSR_PARALLEL_SIZE), n = mb * 4;
+	TCSRMatrix<double> a = make_wide_block_matrix(mb, 4);
+	TBSRMatrix<double, 4> m(a);
+	ASSERT_EQ(mb, m.get_block_rows());
+	const int* bp = m.block_index_data();
+	const int* bc = m.block_cols_data();
+	for (int bi = 0; bi < mb; bi++)
+		for (int k = bp[bi] + 1; k < bp[bi + 1]; k++)
+			ASSERT_LT(bc[k - 1], bc[k]);
+
+	TCSRMatrix<double> back = m.to_csr();
+	ASSERT_EQ(a.non_zeros(), back.non_zeros());
+	const int* ptr = back.row_index_data();
+	const int* col = back.col_indices_data();
+	const double* val = back.values_data();
+	for (int i = 0; i < n; i++)
+		for (int k = ptr[i]; k < ptr[i + 1]; k++)
+			ASSERT_EQ(a(i, col[k]), val[k]) << i << ' ' << col[k];
+
+	TDynamicVector<double> x = make_x(n), y = a * x, z = m * x;
+	for (int i = 0; i < n; i++)
+		ASSERT_NEAR(y[i], z[i], 1e-12);
+
+	// полоса BSR_SPMM_WIDTH столбцов и остаток
+	const size_t k = BSR_SPMM_WIDTH + 2;
+	vector<double> xs(size_t(n) * k), ys(size_t(n) * k);
+	for (int i = 0; i < n; i++)
+		for (size_t j = 0; j < k; j++)
+			xs[size_t(i) * k + j] = double((i + 3 * int(j)) % 7) - 3.0;
+	m.multiply(xs.data(), k, ys.data(), k, k);
+	for (size_t j = 0; j < k; j++) {
+		TDynamicVector<double> cj(n);
+		for (int i = 0; i < n; i++)
+			cj[i] = xs[size_t(i) * k + j];
+		TDynamicVector<double> expected = a * cj;
+		for (int i = 0; i < n; i++)
+			ASSERT_NEAR(expected[i], ys[size_t(i) * k + j], 1e-12);
+	}
+}
+
+TEST(TBSRMatrix, throws_when_size_is_not_multiple_of_block)
+{
+	TCSRMatrix<double> a(7, 6);
+	ASSERT_ANY_THROW((TBSRMatrix<double, 3>(a)));
+}
@@ -0,0 +1,114 @@
+#include "csc_matrix.h"
+
+#include <gtest.h>
+
+// Матрица rows x cols с несколькими элементами в строке; элементы строки
+// добавляются в обратном порядке, чтобы столбцы в CSR не были упорядочены
+static TCSRMatrix<double> make_sparse(int rows, int cols)
+{
+	TCSRMatrix<double> a(rows, cols);
+	for (int i = 0; i < rows; i++)
+		for (int s = 3; s >= 0; s--) {
+			int j = (i * 7 + s * 13) % cols;
+			a.set(i, j, double(i + 1) + 0.25 * s);
+		}
+	return a;
+}
+
+TEST(TCSCMatrix, stores_same_elements_as_csr)
+{
+	TCSRMatrix<double> a = make_sparse(6, 9);
+	TCSCMatrix<double> c(a);
+	EXPECT_EQ(a.non_zeros(), c.non_zeros());
+	for (int i = 0; i < 6; i++)
+		for (int j = 0; j < 9; j++)
+			EXPECT_EQ(a(i, j), c(i, j));
+}
+
+TEST(TCSCMatrix, sorts_rows_inside_columns)
+{
+	TCSCMatrix<double> c(make_sparse(40, 17));
+	for (int j = 0; j < 17; j++)
+		for (int k = c.col_index_data()[j] + 1; k < c.col_index_data()[j + 1]; k++)
+			EXPECT_LT(c.row_indices_data()[k - 1], c.row_indices_data()[k]);
+}
+
+TEST(TCSCMatrix, round_trip_through_parallel_transpose)
+{
+	// достаточно элементов, чтобы строки делились на несколько полос
+	const int n = 10000, per_row = 16;
+	TTrackedVector<int> ptr(n + 1), idx(n * per_row);
+	TTrackedVector<double> val(n * per_row);
+	for (int i = 0; i < n; i++) {
+		ptr[i + 1] = (i + 1) * per_row;
+		for (int s = 0; s < per_row; s++) {
+			idx[i * per_row + s] = (i * 31 + s * 577) % n;
+			val[i * per_row + s] = double(i % 13) + 0.5 * s;
+		}
+	}
+	TCSRMatrix<double> a(n, n, move(ptr), move(idx), move(val));
+	ASSERT_LT(2 * CONVERT_PARALLEL_SIZE, size_t(a.non_zeros()));
+	TCSRMatrix<double> b = TCSCMatrix<double>(a).to_csr();
+	ASSERT_EQ(a.non_zeros(), b.non_zeros());
+	for (int i = 0; i < n; i += 97)
+		for (int j = 0; j < n; j += 13)
+			EXPECT_EQ(a(i, j), b(i, j));
+	TDynamicVector<double> x(n);
+	for (int i = 0; i < n; i++)
+		x[i] = double(i % 5) - 2.0;
+	EXPECT_EQ(a * x, b * x);
+}
+
+TEST(TCSCMatrix, multiplies_by_vector_and_transposed)
+{
+	TCSRMatrix<double> a = make_sparse(7, 5);
+	TCSCMatrix<double> c(a);
+	TDynamicVector<double> x(5), z(7);
+	for (int j = 0; j < 5; j++)
+		x[j] = 1.0 + j;
+	for (int i = 0; i < 7; i++)
+		z[i] = 2.0 - i;
+	EXPECT_EQ(a * x, c * x);
+	EXPECT_EQ(transposed(a) * z, transposed(c) * z);
+}
+
+TEST(TCSCMatrix, multiplies_large_matrix_transposed_in_parallel)
+{
+	// ненулевых больше CSR_SPMV_PARALLEL_SIZE
+	const int n = 5000;
+	TCSRMatrix<double> a = make_sparse(n, n);
+	ASSERT_GE(size_t(a.non_zeros()), CSR_SPMV_PARALLEL_SIZE);
+	TCSCMatrix<double> c(a);
+	TDynamicVector<double> z(n);
+	for (int i = 0; i < n; i++)
+		z[i] = 1.0 + i % 11;
+	EXPECT_EQ(transposed(a) * z, transposed(c) * z);
+}
+
+TEST(TCSCMatrix, extracts_column)
+{
+	TCSRMatrix<double> a = make_sparse(8, 6);
+	TCSCMatrix<double> c(a);
+	TDynamicVector<double> col = c.column(4);
+	for (int i = 0; i < 8; i++)
+		EXPECT_EQ(a(i, 4), col[i]);
+	ASSERT_ANY_THROW(c.column(6));
+}
+
+TEST(TCSCMatrix, throws_on_invalid_arrays)
+{
+	TTrackedVector<int> ptr = { 0, 2, 1 }, idx = { 0, 1 };
+	TTrackedVector<double> val = { 1.0, 2.0 };
+	ASSERT_ANY_THROW(TCSCMatrix<double>(2, 2, move(ptr), move(idx), move(val)));
+}
+
+TEST(transpose, transposes_csr_matrix)
+{
+	TCSRMatrix<double> a = make_sparse(5, 8);
+	TCSRMatrix<double> t = transpose(a);
+	EXPECT_EQ(8, t.get_rows());
+	EXPECT_EQ(5, t.get_cols());
+	for (int i = 0; i < 5; i++)
+		for (int j = 0; j < 8; j++)
+			EXPECT_EQ(a(i, j), t(j, i));
+}
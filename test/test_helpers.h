@@ -0,0 +1,63 @@
+// Генераторы тестовых матриц и векторов, общие для нескольких наборов тестов
+
+#ifndef __TEST_HELPERS_H__
+#define __TEST_HELPERS_H__
+
+#include "dop_matrix.h"
+
+// Пятиточечный оператор Лапласа на сетке k x k с диагональю 4 + shift и
+// конвекцией conv вдоль строк сетки; элементы строки добавляются в обратном
+// порядке, чтобы столбцы в CSR не были упорядочены
+inline TCSRMatrix<double> make_laplace_2d(int k, double shift = 0.0, double conv = 0.0)
+{
+	int n = k * k;
+	TCSRMatrix<double> a(n, n);
+	for (int i = 0; i < n; i++) {
+		int x = i % k, y = i / k;
+		if (y + 1 < k)
+			a.set(i, i + k, -1.0);
+		if (x + 1 < k)
+			a.set(i, i + 1, -1.0 + conv);
+		a.set(i, i, 4.0 + shift);
+		if (x > 0)
+			a.set(i, i - 1, -1.0 - conv);
+		if (y > 0)
+			a.set(i, i - k, -1.0);
+	}
+	return a;
+}
+
+// Трехдиагональная матрица: lo под диагональю, d на ней, up над ней;
+// элементы строки добавляются в обратном порядке
+inline TCSRMatrix<double> make_tridiagonal(int n, double lo, double d, double up)
+{
+	TCSRMatrix<double> a(n, n);
+	for (int i = n - 1; i >= 0; i--) {
+		if (i + 1 < n)
+			a.set(i, i + 1, up);
+		a.set(i, i, d);
+		if (i > 0)
+			a.set(i, i - 1, lo);
+	}
+	return a;
+}
+
+inline TDynamicVector<double> make_rhs(size_t n)
+{
+	TDynamicVector<double> b(n);
+	for (size_t i = 0; i < n; i++)
+		b[i] = 1.0 + double(i % 5);
+	return b;
+}
+
+// Вектор x для проверки умножения матрицы на вектор: значения разных знаков,
+// точно представимые в double
+inline TDynamicVector<double> make_x(int n)
+{
+	TDynamicVector<double> x(n);
+	for (int i = 0; i < n; i++)
+		x[i] = double(i % 4) - 1.5;
+	return x;
+}
+
+#endif
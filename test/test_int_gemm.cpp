@@ -0,0 +1,134 @@
+#include "tmatrix.h"
+
+#include <gtest.h>
+
+// Матрица rows x cols со значениями, пробегающими весь диапазон V
+template<typename V>
+static vector<V> make_values(size_t rows, size_t cols, size_t seed)
+{
+	vector<V> v(rows * cols);
+	long long lo = numeric_limits<V>::min(), span = (long long)numeric_limits<V>::max() - lo + 1;
+	for (size_t i = 0; i < v.size(); i++)
+		v[i] = V(lo + (long long)((i * 2654435761u + seed * 40503u) % size_t(span)));
+	return v;
+}
+
+// C = A * B через gemm_int и прямым тройным циклом в int64
+template<typename TA, typename TB>
+static void expect_exact_product(size_t m, size_t n, size_t p)
+{
+	vector<TA> a = make_values<TA>(m, p, 1);
+	vector<TB> b = make_values<TB>(p, n, 2);
+	// крайние значения: для int16 пара (-32768) * (-32768) дает 2^31
+	a[0] = numeric_limits<TA>::min();
+	b[0] = numeric_limits<TB>::min();
+	a[p - 1] = numeric_limits<TA>::max();
+	b[(p - 1) * n] = numeric_limits<TB>::max();
+	vector<int32_t> c(m * n, 7);
+	gemm_int<TA, TB>(m, n, p,
+		[&](size_t i) { return a.data() + i * p; },
+		[&](size_t k) { return b.data() + k * n; },
+		[&](size_t i) { return c.data() + i * n; });
+	for (size_t i = 0; i < m; i++)
+		for (size_t j = 0; j < n; j++) {
+			long long s = 7;
+			for (size_t k = 0; k < p; k++)
+				s += (long long)a[i * p + k] * b[k * n + j];
+			ASSERT_EQ(int32_t(s), c[i * n + j]) << i << ' ' << j;
+		}
+}
+
+TEST(gemm_int, multiplies_int8_matrices)
+{
+	// p больше INT_GEMM_BLOCK_K и не кратно 4, n не кратно ширине полосы
+	expect_exact_product<int8_t, int8_t>(37, 53, 301);
+}
+
+TEST(gemm_int, multiplies_uint8_by_int8)
+{
+	expect_exact_product<uint8_t, int8_t>(37, 53, 301);
+}
+
+TEST(gemm_int, multiplies_int8_by_uint8)
+{
+	expect_exact_product<int8_t, uint8_t>(37, 53, 301);
+}
+
+TEST(gemm_int, multiplies_uint8_matrices)
+{
+	expect_exact_product<uint8_t, uint8_t>(21, 40, 99);
+}
+
+TEST(gemm_int, multiplies_int16_matrices)
+{
+	expect_exact_product<int16_t, int16_t>(37, 53, 301);
+}
+
+TEST(gemm_int, multiplies_mixed_widths)
+{
+	expect_exact_product<int16_t, uint8_t>(9, 70, 130);
+}
+
+TEST(gemm_int, multiplies_large_matrices_in_parallel)
+{
+	// m * n * p больше INT_GEMM_PARALLEL_SIZE
+	expect_exact_product<int8_t, int8_t>(130, 150, 140);
+}
+
+TEST(int_range, finds_narrowest_type)
+{
+	vector<int> v = { -5, 100, 3 };
+	auto row = [&](size_t) { return v.data(); };
+	TIntRange r = int_range(1, 3, row);
+	EXPECT_TRUE(r.fits_int8());
+	EXPECT_FALSE(r.fits_uint8());
+	v[1] = 200;
+	EXPECT_FALSE(int_range(1, 3, row).fits_int8());
+	EXPECT_TRUE(int_range(1, 3, row).fits_int16());
+	v[0] = 40000;
+	EXPECT_FALSE(int_range(1, 3, row).fits_int16());
+}
+
+TEST(TDynamicMatrix, multiply_i32_widens_narrow_matrices)
+{
+	const size_t n = 40;
+	TDynamicMatrix<int8_t> a(n);
+	TDynamicMatrix<uint8_t> b(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++) {
+			a[i][j] = int8_t(int(i * 7 + j * 3) % 256 - 128);
+			b[i][j] = uint8_t((i * 5 + j * 11) % 256);
+		}
+	TDynamicMatrix<int32_t> c = multiply_i32(a, b);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++) {
+			int32_t s = 0;
+			for (size_t k = 0; k < n; k++)
+				s += int32_t(a[i][k]) * int32_t(b[k][j]);
+			ASSERT_EQ(s, c[i][j]);
+		}
+}
+
+TEST(TDynamicMatrix, int_product_is_exact_for_narrow_and_wide_values)
+{
+	const size_t n = 50;
+	// значения int8, int16 и одно, выходящее за int16
+	for (int scale : { 1, 200, 201 }) {
+		TDynamicMatrix<int> a(n), b(n);
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = 0; j < n; j++) {
+				a[i][j] = (int(i * 13 + j * 7) % 255 - 127) * scale / 127;
+				b[i][j] = (int(i * 3 + j * 17) % 255 - 127) * scale / 127;
+			}
+		if (scale == 201)
+			a[3][4] = 40000;
+		TDynamicMatrix<int> c = a * b;
+		for (size_t i = 0; i < n; i++)
+			for (size_t j = 0; j < n; j++) {
+				long long s = 0;
+				for (size_t k = 0; k < n; k++)
+					s += (long long)a[i][k] * b[k][j];
+				ASSERT_EQ(int(s), c[i][j]) << scale;
+			}
+	}
+}
@@ -0,0 +1,144 @@
+#include "lu.h"
+
+#include <gtest.h>
+
+// Матрица без диагонального преобладания, чтобы выбор ведущего элемента
+// действительно переставлял строки
+static TDynamicMatrix<double> make_lu_matrix(size_t n)
+{
+	TDynamicMatrix<double> a(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			a[i][j] = double((7 * i + 13 * j + i * j) % 23) - 11.0 + (i == j ? 0.5 : 0.0);
+	return a;
+}
+
+static double max_abs_diff(const TDynamicMatrix<double>& a, const TDynamicMatrix<double>& b)
+{
+	double d = 0.0;
+	for (size_t i = 0; i < a.size(); i++)
+		for (size_t j = 0; j < a.size(); j++)
+			d = max(d, abs(a[i][j] - b[i][j]));
+	return d;
+}
+
+// Проверка PA = LU для матрицы, раскладываемой в несколько блоков
+static void check_factorization(size_t n)
+{
+	TDynamicMatrix<double> a = make_lu_matrix(n), f(a);
+	vector<size_t> piv;
+	ASSERT_TRUE(lu_factor(f, piv));
+	for (size_t k = 0; k < n; k++)
+		swap(a[k], a[piv[k]]);
+	TDynamicMatrix<double> prod(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++) {
+			double s = 0.0;
+			for (size_t k = 0; k <= min(i, j); k++)
+				s += (k == i ? 1.0 : f[i][k]) * f[k][j];
+			prod[i][j] = s;
+		}
+	EXPECT_LT(max_abs_diff(a, prod), 1e-9);
+}
+
+TEST(lu_factor, reconstructs_permuted_matrix)
+{
+	check_factorization(150);
+}
+
+TEST(lu_factor, reconstructs_permuted_matrix_with_parallel_update)
+{
+	check_factorization(300);
+}
+
+TEST(lu_factor, chooses_largest_pivot)
+{
+	TDynamicMatrix<double> a(2);
+	a[0][0] = 1.0; a[0][1] = 2.0;
+	a[1][0] = 4.0; a[1][1] = 3.0;
+	vector<size_t> piv;
+	lu_factor(a, piv);
+	EXPECT_EQ(1, piv[0]);
+	EXPECT_EQ(4.0, a[0][0]);
+	EXPECT_EQ(0.25, a[1][0]);
+	EXPECT_EQ(2.0 - 0.75, a[1][1]);
+}
+
+TEST(lu_factor, reports_singular_matrix)
+{
+	TDynamicMatrix<double> a(3);
+	for (size_t i = 0; i < 3; i++)
+		for (size_t j = 0; j < 3; j++)
+			a[i][j] = double(i + j);
+	vector<size_t> piv;
+	EXPECT_FALSE(lu_factor(a, piv));
+}
+
+TEST(TLUDecomposition, computes_determinant)
+{
+	TDynamicMatrix<double> a(3);
+	a[0][0] = 0.0; a[0][1] = 2.0; a[0][2] = 1.0;
+	a[1][0] = 1.0; a[1][1] = 1.0; a[1][2] = 0.0;
+	a[2][0] = 3.0; a[2][1] = 0.0; a[2][2] = 2.0;
+	EXPECT_NEAR(-7.0, determinant(a), 1e-12);
+}
+
+TEST(TLUDecomposition, determinant_of_singular_matrix_is_zero)
+{
+	TDynamicMatrix<double> a(3);
+	for (size_t i = 0; i < 3; i++)
+		for (size_t j = 0; j < 3; j++)
+			a[i][j] = double(i + j);
+	EXPECT_EQ(0.0, determinant(a));
+}
+
+TEST(TLUDecomposition, solves_system)
+{
+	const size_t n = 200;
+	TDynamicMatrix<double> a = make_lu_matrix(n);
+	TDynamicVector<double> x(n);
+	for (size_t i = 0; i < n; i++)
+		x[i] = double(i % 9) - 4.0;
+	TDynamicVector<double> b = a * x;
+	TDynamicVector<double> y = solve(a, b);
+	for (size_t i = 0; i < n; i++)
+		EXPECT_NEAR(x[i], y[i], 1e-8);
+}
+
+TEST(TLUDecomposition, solves_system_with_many_right_hand_sides)
+{
+	const size_t n = 130;
+	TDynamicMatrix<double> a = make_lu_matrix(n), x(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			x[i][j] = double((i + 2 * j) % 5) - 2.0;
+	TDynamicMatrix<double> b = a * x;
+	TLUDecomposition<double> lu(a);
+	EXPECT_LT(max_abs_diff(x, lu.solve(b)), 1e-8);
+}
+
+TEST(TLUDecomposition, computes_inverse)
+{
+	const size_t n = 130;
+	TDynamicMatrix<double> a = make_lu_matrix(n), e(n);
+	for (size_t i = 0; i < n; i++)
+		e[i][i] = 1.0;
+	EXPECT_LT(max_abs_diff(e, a * inverse(a)), 1e-8);
+}
+
+TEST(TLUDecomposition, throws_when_solving_singular_system)
+{
+	TDynamicMatrix<double> a(2);
+	a[0][0] = 1.0; a[0][1] = 2.0;
+	a[1][0] = 2.0; a[1][1] = 4.0;
+	TLUDecomposition<double> lu(a);
+	EXPECT_TRUE(lu.is_singular());
+	ASSERT_ANY_THROW(lu.solve(TDynamicVector<double>(2)));
+	ASSERT_ANY_THROW(inverse(a));
+}
+
+TEST(TLUDecomposition, throws_when_sizes_dont_match)
+{
+	TLUDecomposition<double> lu(make_lu_matrix(3));
+	ASSERT_ANY_THROW(lu.solve(TDynamicVector<double>(4)));
+}
@@ -0,0 +1,176 @@
+#include "matrix_io.h"
+
+#include <gtest.h>
+#include <iomanip>
+#include <sstream>
+
+static TDynamicMatrix<double> make_io_matrix(size_t n)
+{
+	TDynamicMatrix<double> m(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			m[i][j] = (double(i) - double(j)) / 7.0 * (j % 3 == 0 ? 1e-5 : 1e6);
+	return m;
+}
+
+TEST(MatrixIO, write_matrix_matches_stream_output_for_doubles)
+{
+	TDynamicMatrix<double> m = make_io_matrix(20);
+	ostringstream expected, actual;
+	expected << m;
+	write_matrix(actual, m);
+	EXPECT_EQ(expected.str(), actual.str());
+}
+
+TEST(MatrixIO, write_matrix_matches_stream_output_for_ints)
+{
+	TDynamicMatrix<int> m(5);
+	for (size_t i = 0; i < 5; i++)
+		for (size_t j = 0; j < 5; j++)
+			m[i][j] = int(i * 1000) - int(j * 77);
+	ostringstream expected, actual;
+	expected << m;
+	write_matrix(actual, m);
+	EXPECT_EQ(expected.str(), actual.str());
+}
+
+TEST(MatrixIO, write_matrix_respects_fixed_precision)
+{
+	TDynamicMatrix<double> m = make_io_matrix(7);
+	ostringstream expected, actual;
+	expected << fixed << setprecision(3) << m;
+	actual << fixed << setprecision(3);
+	write_matrix(actual, m);
+	EXPECT_EQ(expected.str(), actual.str());
+}
+
+TEST(MatrixIO, write_matrix_falls_back_for_unsupported_flags)
+{
+	TDynamicMatrix<double> m = make_io_matrix(4);
+	ostringstream expected, actual;
+	expected << showpos << m;
+	actual << showpos;
+	write_matrix(actual, m);
+	EXPECT_EQ(expected.str(), actual.str());
+}
+
+TEST(MatrixIO, parallel_write_matches_stream_output)
+{
+	TDynamicMatrix<double> m = make_io_matrix(300);
+	ostringstream expected, actual;
+	expected << m;
+	write_matrix(actual, m, true);
+	EXPECT_EQ(expected.str(), actual.str());
+}
+
+TEST(MatrixIO, write_vector_matches_stream_output)
+{
+	TDynamicVector<double> v(5);
+	v[0] = 1.5; v[1] = -2e-9; v[2] = 3e20; v[3] = 0.1; v[4] = 1.0 / 3.0;
+	ostringstream expected, actual;
+	expected << v;
+	write_vector(actual, v);
+	EXPECT_EQ(expected.str(), actual.str());
+}
+
+TEST(MatrixIO, read_matrix_reads_what_write_matrix_writes)
+{
+	TDynamicMatrix<double> m = make_io_matrix(50), r(50);
+	stringstream ss;
+	ss << setprecision(17);
+	write_matrix(ss, m);
+	read_matrix(ss, r);
+	EXPECT_EQ(m, r);
+}
+
+TEST(MatrixIO, read_vector_accepts_any_whitespace_and_plus_sign)
+{
+	TDynamicVector<int> v(4);
+	istringstream ss(" 1\t+2\n\n-3   4");
+	read_vector(ss, v);
+	EXPECT_EQ(1, v[0]);
+	EXPECT_EQ(2, v[1]);
+	EXPECT_EQ(-3, v[2]);
+	EXPECT_EQ(4, v[3]);
+}
+
+TEST(MatrixIO, read_leaves_rest_of_stream_unread)
+{
+	TDynamicVector<int> v(2);
+	istringstream ss("1 2 3 4");
+	read_vector(ss, v);
+	int rest;
+	ss >> rest;
+	EXPECT_EQ(3, rest);
+}
+
+// Буфер потока без позиционирования, как у канала или stdin
+class TPipeBuf : public stringbuf
+{
+public:
+	explicit TPipeBuf(const string& s) : stringbuf(s, ios_base::in) {}
+protected:
+	pos_type seekoff(off_type, ios_base::seekdir, ios_base::openmode) override { return pos_type(off_type(-1)); }
+	pos_type seekpos(pos_type, ios_base::openmode) override { return pos_type(off_type(-1)); }
+};
+
+TEST(MatrixIO, read_from_non_seekable_stream_keeps_it_usable)
+{
+	TPipeBuf buf("1 2 3 4");
+	istream in(&buf);
+	TDynamicVector<int> v(2);
+	read_vector(in, v);
+	EXPECT_EQ(2, as_const(v)[1]);
+	EXPECT_FALSE(in.fail());
+	// байты после последнего числа остаются в потоке
+	int rest;
+	in >> rest;
+	EXPECT_EQ(3, rest);
+}
+
+TEST(MatrixIO, consecutive_reads_from_non_seekable_stream_succeed)
+{
+	string text;
+	for (int i = 0; i < 3 * int(READ_BUFFER_SIZE); i++)
+		text += "7 ";
+	TPipeBuf buf(text);
+	istream in(&buf);
+	TDynamicVector<int> v(3 * READ_BUFFER_SIZE / 2);
+	read_vector(in, v);
+	EXPECT_FALSE(in.fail());
+	EXPECT_EQ(7, as_const(v)[v.size() - 1]);
+}
+
+TEST(MatrixIO, read_handles_numbers_split_between_blocks)
+{
+	const size_t n = READ_BUFFER_SIZE / 7 + 10;
+	string text;
+	for (size_t i = 0; i < n; i++)
+		text += to_string(100000 + i) + ' ';
+	TDynamicVector<int> v(n);
+	istringstream ss(text);
+	read_vector(ss, v);
+	for (size_t i = 0; i < n; i++)
+		ASSERT_EQ(int(100000 + i), v[i]);
+}
+
+TEST(MatrixIO, read_throws_on_malformed_number)
+{
+	TDynamicMatrix<int> m(2);
+	istringstream ss("1 2 x3 4");
+	try {
+		read_matrix(ss, m);
+		FAIL();
+	}
+	catch (const matrix_parse_error& e) {
+		EXPECT_EQ(2, e.element());
+		EXPECT_EQ(4, e.offset());
+	}
+}
+
+TEST(MatrixIO, read_throws_on_unexpected_end_of_input)
+{
+	TDynamicVector<double> v(3);
+	istringstream ss("1.5 2.5");
+	ASSERT_THROW(read_vector(ss, v), matrix_parse_error);
+}
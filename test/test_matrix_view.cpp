@@ -0,0 +1,152 @@
+#include "matrix_view.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<int> make_view_matrix(size_t n)
+{
+	TDynamicMatrix<int> m(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			m[i][j] = static_cast<int>(i * 10 + j);
+	return m;
+}
+
+TEST(TVectorView, range_view_refers_to_vector_memory)
+{
+	TDynamicVector<int> v(5);
+	TVectorView<int> r = range_view(v, 1, 3);
+	r[0] = 7;
+	EXPECT_EQ(7, v[1]);
+	EXPECT_EQ(3, r.size());
+}
+
+TEST(TVectorView, view_of_copy_on_write_vector_doesnt_change_later_copy)
+{
+	TDynamicVector<int> v(5);
+	v.set_storage(TStorage::CopyOnWrite);
+	TVectorView<int> r = range_view(v, 1, 3);
+	TDynamicVector<int> w(v);
+	r[0] = 7;
+	EXPECT_EQ(7, as_const(v)[1]);
+	EXPECT_EQ(0, as_const(w)[1]);
+}
+
+TEST(TMatrixView, view_of_copy_on_write_matrix_doesnt_change_later_copy)
+{
+	TDynamicMatrix<int> m = make_view_matrix(4);
+	m.set_storage(TStorage::CopyOnWrite);
+	TMatrixView<int> b = block_view(m, 1, 1, 2, 2);
+	TVectorView<int> row = b.row(0);
+	TDynamicMatrix<int> m1(m);
+	b(1, 1) = -1;
+	row[0] = -2;
+	b.col(1)[0] = -3;
+	EXPECT_EQ(-1, as_const(m)[2][2]);
+	EXPECT_EQ(-2, as_const(m)[1][1]);
+	EXPECT_EQ(-3, as_const(m)[1][2]);
+	EXPECT_EQ(22, as_const(m1)[2][2]);
+	EXPECT_EQ(11, as_const(m1)[1][1]);
+	EXPECT_EQ(12, as_const(m1)[1][2]);
+}
+
+TEST(TVectorView, throws_when_range_out_of_vector)
+{
+	TDynamicVector<int> v(5);
+	ASSERT_ANY_THROW(range_view(v, 3, 3));
+}
+
+TEST(TVectorView, can_add_views_and_vectors)
+{
+	TDynamicMatrix<int> m = make_view_matrix(3);
+	TDynamicVector<int> v(3), expected(3);
+	v[0] = 1; v[1] = 1; v[2] = 1;
+	expected[0] = 11; expected[1] = 12; expected[2] = 13;
+	EXPECT_EQ(expected, row_view(m, 1) + v);
+	EXPECT_EQ(expected, v + row_view(m, 1));
+}
+
+TEST(TVectorView, can_compute_dot_product_of_row_and_column)
+{
+	TDynamicMatrix<int> m = make_view_matrix(3);
+	// строка 0: 0 1 2, столбец 2: 2 12 22
+	EXPECT_EQ(0 * 2 + 1 * 12 + 2 * 22, row_view(m, 0) * column_view(m, 2));
+}
+
+TEST(TVectorView, dot_product_of_strided_views_uses_step)
+{
+	TDynamicVector<int> v(6);
+	for (size_t i = 0; i < 6; i++)
+		v[i] = int(i) + 1;
+	// элементы 1, 3, 5 и 2, 4, 6
+	TVectorView<const int> odd(as_const(v).data(), 3, 2), even(as_const(v).data() + 1, 3, 2);
+	EXPECT_EQ(1 * 2 + 3 * 4 + 5 * 6, odd * even);
+	EXPECT_EQ(2, even.step());
+	EXPECT_EQ(v.dot(v), range_view(as_const(v), 0, 6) * v);
+}
+
+TEST(TVectorView, compound_assignment_modifies_matrix_in_place)
+{
+	TDynamicMatrix<int> m = make_view_matrix(3);
+	column_view(m, 0) += row_view(m, 2);
+	EXPECT_EQ(20, m[0][0]);
+	EXPECT_EQ(31, m[1][0]);
+	EXPECT_EQ(42, m[2][0]);
+	row_view(m, 1) *= 2;
+	EXPECT_EQ(62, m[1][0]);
+	EXPECT_EQ(22, m[1][1]);
+}
+
+TEST(TMatrixView, block_view_reads_and_writes_submatrix)
+{
+	TDynamicMatrix<int> m = make_view_matrix(4);
+	TMatrixView<int> b = block_view(m, 1, 2, 2, 2);
+	EXPECT_EQ(12, b(0, 0));
+	EXPECT_EQ(23, b(1, 1));
+	b(1, 0) = -1;
+	EXPECT_EQ(-1, m[2][2]);
+	EXPECT_EQ(13, b.col(1)[0]);
+	EXPECT_EQ(-1, b.row(1)[0]);
+}
+
+TEST(TMatrixView, gemm_on_blocks_matches_full_product)
+{
+	TDynamicMatrix<int> a = make_view_matrix(6), b = make_view_matrix(6), c(6);
+	TDynamicMatrix<int> expected = a * b;
+	// C = A11 * B1 + A12 * B2 по блокам столбцов A и строк B
+	gemm(matrix_view(c), block_view(a, 0, 0, 6, 2), block_view(b, 0, 0, 2, 6));
+	gemm(matrix_view(c), block_view(a, 0, 2, 6, 4), block_view(b, 2, 0, 4, 6));
+	EXPECT_EQ(expected, c);
+}
+
+TEST(TMatrixView, can_multiply_block_by_vector_view)
+{
+	TDynamicMatrix<int> m = make_view_matrix(3);
+	TDynamicVector<int> y = block_view(m, 0, 1, 2, 2) * column_view(m, 0).sub(0, 2);
+	// [1 2; 11 12] * [0; 10]
+	EXPECT_EQ(20, y[0]);
+	EXPECT_EQ(120, y[1]);
+}
+
+TEST(TMatrixView, can_multiply_block_by_row_view)
+{
+	TDynamicMatrix<int> m = make_view_matrix(4);
+	TDynamicVector<int> y = block_view(m, 1, 0, 2, 3) * row_view(m, 3).sub(1, 3);
+	// [10 11 12; 20 21 22] * [31; 32; 33]
+	EXPECT_EQ(10 * 31 + 11 * 32 + 12 * 33, y[0]);
+	EXPECT_EQ(20 * 31 + 21 * 32 + 22 * 33, y[1]);
+}
+
+TEST(TVectorView, contiguous_view_data_can_be_passed_to_matrix_kernels)
+{
+	TDynamicMatrix<int> a = make_view_matrix(3), m = make_view_matrix(4);
+	TDynamicVector<int> expected = a * to_vector(row_view(m, 2).sub(1, 3));
+	TDynamicVector<int> y(3);
+	a.multiply(row_view(as_const(m), 2).sub(1, 3).data(), y.data());
+	EXPECT_EQ(expected, y);
+}
+
+TEST(TMatrixView, throws_when_block_out_of_matrix)
+{
+	TDynamicMatrix<int> m(3);
+	ASSERT_ANY_THROW(block_view(m, 2, 2, 2, 1));
+}
@@ -0,0 +1,259 @@
+#include "preconditioners.h"
+#include "solvers.h"
+#include "test_helpers.h"
+
+#include <gtest.h>
+
+// Блочно-диагональная матрица из трехдиагональных блоков длины block:
+// ILU(0) и IC(0) для нее точны, а уровней в расписании всего block
+static TCSRMatrix<double> make_block_tridiagonal(int n, int block, double lo, double d, double up)
+{
+	TCSRMatrix<double> a(n, n);
+	for (int i = n - 1; i >= 0; i--) {
+		if (i + 1 < n && (i + 1) % block != 0)
+			a.set(i, i + 1, up);
+		a.set(i, i, d);
+		if (i % block != 0)
+			a.set(i, i - 1, lo);
+	}
+	return a;
+}
+
+// || A M^{-1} r - r ||
+template<class Precond>
+static double exactness(const TCSRMatrix<double>& a, const Precond& m, const TDynamicVector<double>& r)
+{
+	TDynamicVector<double> z(r.size());
+	m.apply(r.data(), z.data());
+	TDynamicVector<double> d = a * z - r;
+	return sqrt(d * d);
+}
+
+TEST(TCSRSymbolic, sorts_columns_and_finds_diagonal)
+{
+	TCSRMatrix<double> a = make_tridiagonal(4, -1.0, 2.0, -1.0);
+	TCSRSymbolic s(a);
+	for (int i = 0; i < 4; i++) {
+		EXPECT_EQ(i, s.col[s.diag[i]]);
+		for (int k = s.ptr[i] + 1; k < s.ptr[i + 1]; k++)
+			EXPECT_LT(s.col[k - 1], s.col[k]);
+	}
+}
+
+TEST(TCSRSymbolic, groups_independent_rows_into_levels)
+{
+	const int k = 10;
+	TCSRSymbolic s(make_laplace_2d(k));
+	// на пятиточечном шаблоне уровень строки - номер ее антидиагонали сетки
+	EXPECT_EQ(size_t(2 * k - 1) + 1, s.lower_ptr.size());
+	EXPECT_EQ(size_t(2 * k - 1) + 1, s.upper_ptr.size());
+	EXPECT_EQ(k * k, s.lower_ptr.back());
+}
+
+TEST(TCSRSymbolic, schedules_wide_levels_in_parallel)
+{
+	// 10000 строк в 4 уровнях, ненулевых больше PRECOND_PARALLEL_SIZE
+	TCSRSymbolic s(make_block_tridiagonal(10000, 4, -1.0, 3.0, -1.0));
+	ASSERT_GE(s.col.size(), PRECOND_PARALLEL_SIZE);
+	EXPECT_EQ(size_t(5), s.lower_ptr.size());
+	EXPECT_TRUE(s.lower_parallel);
+	EXPECT_TRUE(s.upper_parallel);
+	// на антидиагоналях сетки 20 x 20 в среднем меньше PRECOND_LEVEL_WIDTH строк
+	EXPECT_FALSE(TCSRSymbolic(make_laplace_2d(20)).lower_parallel);
+}
+
+TEST(TCSRSymbolic, throws_when_diagonal_is_missing)
+{
+	TCSRMatrix<double> a(3, 3);
+	a.set(0, 0, 1.0);
+	a.set(1, 2, 1.0);
+	a.set(2, 2, 1.0);
+	ASSERT_ANY_THROW(TCSRSymbolic s(a));
+}
+
+TEST(TJacobiPreconditioner, divides_by_diagonal)
+{
+	TCSRMatrix<double> a = make_tridiagonal(3, 1.0, 4.0, 1.0);
+	a.set(1, 1, 2.0);
+	TJacobiPreconditioner<double> m(a);
+	double r[3] = { 4.0, 4.0, 2.0 }, z[3];
+	m.apply(r, z);
+	EXPECT_EQ(1.0, z[0]);
+	EXPECT_EQ(2.0, z[1]);
+	EXPECT_EQ(0.5, z[2]);
+}
+
+TEST(TJacobiPreconditioner, divides_long_vector_in_parallel)
+{
+	const int n = int(PRECOND_VECTOR_PARALLEL_SIZE) + 5;
+	TCSRMatrix<double> a = make_tridiagonal(n, -1.0, 4.0, -1.0);
+	TJacobiPreconditioner<double> m(a);
+	TDynamicVector<double> r = make_rhs(n), z(n);
+	m.apply(r.data(), z.data());
+	for (int i = 0; i < n; i++)
+		ASSERT_EQ(r[i] / 4.0, z[i]);
+}
+
+TEST(TJacobiPreconditioner, throws_on_zero_diagonal)
+{
+	TCSRMatrix<double> a(2, 2);
+	a.set(0, 0, 1.0);
+	a.set(1, 0, 1.0);
+	ASSERT_ANY_THROW(TJacobiPreconditioner<double> m(a));
+}
+
+TEST(TILU0Preconditioner, is_exact_for_tridiagonal_matrix)
+{
+	TCSRMatrix<double> a = make_tridiagonal(50, -1.3, 3.0, -0.7);
+	TILU0Preconditioner<double> m(a);
+	TDynamicVector<double> r = make_rhs(50);
+	EXPECT_LT(exactness(a, m, r), 1e-12);
+}
+
+TEST(TILU0Preconditioner, is_exact_on_parallel_level_schedule)
+{
+	TCSRMatrix<double> a = make_block_tridiagonal(10000, 4, -1.3, 3.0, -0.7);
+	TILU0Preconditioner<double> m(a);
+	ASSERT_TRUE(m.symbolic().lower_parallel);
+	TDynamicVector<double> r = make_rhs(10000);
+	EXPECT_LT(exactness(a, m, r), 1e-10);
+	TCSRMatrix<double> b = make_block_tridiagonal(10000, 4, 0.5, 5.0, -2.0);
+	m.refactor(b);
+	EXPECT_LT(exactness(b, m, r), 1e-10);
+}
+
+TEST(TILU0Preconditioner, can_refactor_values_with_same_pattern)
+{
+	TCSRMatrix<double> a = make_tridiagonal(20, -1.0, 3.0, -1.0);
+	TILU0Preconditioner<double> m(a);
+	TCSRMatrix<double> b = make_tridiagonal(20, 0.5, 5.0, -2.0);
+	m.refactor(b);
+	TDynamicVector<double> r = make_rhs(20);
+	EXPECT_LT(exactness(b, m, r), 1e-12);
+}
+
+TEST(TILU0Preconditioner, throws_when_refactor_pattern_differs)
+{
+	TCSRMatrix<double> a = make_tridiagonal(5, -1.0, 3.0, -1.0);
+	TILU0Preconditioner<double> m(a);
+	a.set(0, 4, 1.0);
+	ASSERT_ANY_THROW(m.refactor(a));
+}
+
+TEST(TILU0Preconditioner, throws_on_zero_pivot)
+{
+	TCSRMatrix<double> a = make_tridiagonal(3, 1.0, 1.0, 1.0);
+	ASSERT_ANY_THROW(TILU0Preconditioner<double> m(a));
+}
+
+TEST(TILU0Preconditioner, matches_dense_incomplete_factorization)
+{
+	const int k = 4, n = k * k;
+	TCSRMatrix<double> a = make_laplace_2d(k, 0.5, 0.3);
+	TILU0Preconditioner<double> m(a);
+	// плотное ILU(0): исключение, ограниченное шаблоном A
+	TDynamicMatrix<double> lu(n);
+	for (int i = 0; i < n; i++)
+		for (int j = 0; j < n; j++)
+			lu[i][j] = a(i, j);
+	for (int i = 1; i < n; i++)
+		for (int kk = 0; kk < i; kk++) {
+			if (a(i, kk) == 0.0)
+				continue;
+			lu[i][kk] /= lu[kk][kk];
+			for (int j = kk + 1; j < n; j++)
+				if (a(i, j) != 0.0)
+					lu[i][j] -= lu[i][kk] * lu[kk][j];
+		}
+	TDynamicVector<double> r = make_rhs(n), y(n), z(n);
+	for (int i = 0; i < n; i++) {
+		y[i] = r[i];
+		for (int j = 0; j < i; j++)
+			y[i] -= lu[i][j] * y[j];
+	}
+	for (int i = n - 1; i >= 0; i--) {
+		z[i] = y[i];
+		for (int j = i + 1; j < n; j++)
+			z[i] -= lu[i][j] * z[j];
+		z[i] /= lu[i][i];
+	}
+	TDynamicVector<double> got(n);
+	m.apply(r.data(), got.data());
+	for (int i = 0; i < n; i++)
+		EXPECT_NEAR(z[i], got[i], 1e-12);
+}
+
+TEST(TIC0Preconditioner, is_exact_for_tridiagonal_matrix)
+{
+	TCSRMatrix<double> a = make_tridiagonal(40, -1.0, 2.5, -1.0);
+	TIC0Preconditioner<double> m(a);
+	TDynamicVector<double> r = make_rhs(40);
+	EXPECT_LT(exactness(a, m, r), 1e-12);
+}
+
+TEST(TIC0Preconditioner, is_exact_on_parallel_level_schedule)
+{
+	TCSRMatrix<double> a = make_block_tridiagonal(10000, 4, -1.0, 2.5, -1.0);
+	TIC0Preconditioner<double> m(a);
+	ASSERT_TRUE(m.symbolic().lower_parallel);
+	ASSERT_TRUE(m.symbolic().upper_parallel);
+	TDynamicVector<double> r = make_rhs(10000);
+	EXPECT_LT(exactness(a, m, r), 1e-10);
+}
+
+TEST(TIC0Preconditioner, throws_on_nonsymmetric_pattern)
+{
+	TCSRMatrix<double> a = make_tridiagonal(4, -1.0, 2.0, -1.0);
+	a.set(0, 3, -0.1);
+	ASSERT_ANY_THROW(TIC0Preconditioner<double> m(a));
+}
+
+TEST(TIC0Preconditioner, throws_on_indefinite_matrix)
+{
+	TCSRMatrix<double> a = make_tridiagonal(4, -2.0, 1.0, -2.0);
+	ASSERT_ANY_THROW(TIC0Preconditioner<double> m(a));
+}
+
+TEST(cg, converges_faster_with_ic0)
+{
+	TCSRMatrix<double> a = make_laplace_2d(20);
+	TDynamicVector<double> b = make_rhs(400), x0(400), x1(400), x2(400);
+	TSolverReport plain = cg(a, b, x0);
+	TSolverReport jacobi = cg(a, b, x1, TJacobiPreconditioner<double>(a));
+	TSolverReport ic = cg(a, b, x2, TIC0Preconditioner<double>(a));
+	ASSERT_TRUE(plain.converged);
+	ASSERT_TRUE(jacobi.converged);
+	ASSERT_TRUE(ic.converged);
+	EXPECT_LT(ic.iterations, plain.iterations);
+	TDynamicVector<double> d = a * x2 - b;
+	EXPECT_LT(sqrt(d * d), 1e-6 * sqrt(b * b));
+}
+
+TEST(bicgstab, converges_faster_with_ilu0)
+{
+	TCSRMatrix<double> a = make_laplace_2d(20, 0.0, 0.5);
+	TDynamicVector<double> b = make_rhs(400), x0(400), x1(400);
+	TILU0Preconditioner<double> m(a);
+	TSolverReport plain = bicgstab(a, b, x0);
+	TSolverReport ilu = bicgstab(a, b, x1, m);
+	ASSERT_TRUE(ilu.converged);
+	EXPECT_LT(ilu.iterations, plain.iterations);
+	TDynamicVector<double> d = a * x1 - b;
+	EXPECT_LT(sqrt(d * d), 1e-6 * sqrt(b * b));
+}
+
+TEST(gmres, converges_faster_with_ilu0)
+{
+	TCSRMatrix<double> a = make_laplace_2d(20, 0.0, 0.5);
+	TDynamicVector<double> b = make_rhs(400), x0(400), x1(400);
+	TILU0Preconditioner<double> m(a);
+	TKrylovWorkspace<double> ws;
+	TSolverOptions opt;
+	opt.restart = 20;
+	TSolverReport plain = gmres(a, b, x0, ws, opt);
+	TSolverReport ilu = gmres(a, b, x1, m, ws, opt);
+	ASSERT_TRUE(ilu.converged);
+	EXPECT_LT(ilu.iterations, plain.iterations);
+	TDynamicVector<double> d = a * x1 - b;
+	EXPECT_LT(sqrt(d * d), 1e-6 * sqrt(b * b));
+}
@@ -0,0 +1,94 @@
+#include "reordering.h"
+#include "test_helpers.h"
+
+#include <gtest.h>
+
+// Пятиточечный оператор Лапласа с узлами, перенумерованными перестановкой
+// i -> (i * step) % n, которая разбрасывает соседей по матрице
+static TCSRMatrix<double> make_scrambled_laplace(int k, int step, double conv = 0.0)
+{
+	int n = k * k;
+	vector<int> perm(n);
+	for (int i = 0; i < n; i++)
+		perm[i] = int((long long)i * step % n);
+	return permute(make_laplace_2d(k, 0.0, conv), perm);
+}
+
+TEST(rcm_ordering, returns_permutation)
+{
+	TCSRMatrix<double> a = make_scrambled_laplace(9, 7);
+	vector<int> perm = rcm_ordering(a);
+	ASSERT_EQ(size_t(81), perm.size());
+	vector<int> sorted(perm);
+	sort(sorted.begin(), sorted.end());
+	for (int i = 0; i < 81; i++)
+		EXPECT_EQ(i, sorted[i]);
+}
+
+TEST(rcm_ordering, covers_disconnected_components)
+{
+	TCSRMatrix<double> a(6, 6);
+	for (int i = 0; i < 6; i++)
+		a.set(i, i, 1.0);
+	a.set(0, 4, 1.0);
+	a.set(4, 0, 1.0);
+	a.set(2, 5, 1.0);
+	EXPECT_EQ(size_t(6), rcm_ordering(a).size());
+	TRCMResult<double> r = rcm_reorder(a);
+	EXPECT_EQ(1, r.after.lower);
+	EXPECT_EQ(1, r.after.upper);
+}
+
+TEST(permute, applies_symmetric_permutation)
+{
+	TCSRMatrix<double> a = make_scrambled_laplace(5, 3, 0.25);
+	vector<int> perm = rcm_ordering(a);
+	TCSRMatrix<double> b = permute(a, perm);
+	for (int i = 0; i < 25; i++)
+		for (int j = 0; j < 25; j++)
+			EXPECT_EQ(a(perm[i], perm[j]), b(i, j));
+	ASSERT_ANY_THROW(permute(a, vector<int>(25, 0)));
+}
+
+TEST(rcm_reorder, narrows_band_of_grid_matrix)
+{
+	const int k = 30;
+	TRCMResult<double> r = rcm_reorder(make_scrambled_laplace(k, 37));
+	EXPECT_GT(r.before.lower, 10 * k);
+	// на сетке k x k RCM дает ленту порядка k
+	EXPECT_LE(r.after.lower, k + 1);
+	EXPECT_EQ(r.after.lower, r.after.upper);
+	EXPECT_TRUE(r.is_narrow());
+}
+
+TEST(rcm_reorder, emits_symmetric_band_matrix)
+{
+	const int k = 12;
+	TCSRMatrix<double> a = make_scrambled_laplace(k, 5);
+	TRCMResult<double> r = rcm_reorder(a);
+	optional<TSymmetricBandMatrix<double>> band = rcm_symmetric_band(r, 0.2);
+	ASSERT_TRUE(band.has_value());
+	TDynamicVector<double> x(k * k);
+	for (int i = 0; i < k * k; i++)
+		x[i] = double(i % 5) - 2.0;
+	TDynamicVector<double> y = r.matrix * x, z = *band * x;
+	for (int i = 0; i < k * k; i++)
+		EXPECT_NEAR(y[i], z[i], 1e-12);
+}
+
+TEST(rcm_reorder, emits_general_band_for_nonsymmetric_matrix)
+{
+	const int k = 12;
+	TRCMResult<double> r = rcm_reorder(make_scrambled_laplace(k, 5, 0.3));
+	EXPECT_FALSE(rcm_symmetric_band(r, 0.2).has_value());
+	optional<TGeneralBandMatrix<double>> band = rcm_band(r, 0.2);
+	ASSERT_TRUE(band.has_value());
+	EXPECT_EQ(r.after.lower, band->lower_band());
+	EXPECT_EQ(r.matrix.to_dense(), band->to_dense());
+}
+
+TEST(rcm_reorder, rejects_wide_band)
+{
+	TRCMResult<double> r = rcm_reorder(make_scrambled_laplace(6, 5));
+	EXPECT_FALSE(rcm_band(r, 0.05).has_value());
+}
@@ -0,0 +1,71 @@
+#include "sell_matrix.h"
+#include "test_helpers.h"
+
+#include <gtest.h>
+
+// Строки разной длины: в строке i - (i * 7) % 11 элементов
+static TCSRMatrix<double> make_uneven(int rows, int cols)
+{
+	TCSRMatrix<double> a(rows, cols);
+	for (int i = 0; i < rows; i++)
+		for (int s = (i * 7) % 11; s > 0; s--)
+			a.set(i, (i * 5 + s * 17) % cols, double(s) - 0.5 * double(i % 3));
+	return a;
+}
+
+static void expect_same_product(const TCSRMatrix<double>& a, int sigma)
+{
+	TSELLMatrix<double, 8> s(a, sigma);
+	TDynamicVector<double> x = make_x(a.get_cols()), y = a * x, z = s * x;
+	for (int i = 0; i < a.get_rows(); i++)
+		EXPECT_NEAR(y[i], z[i], 1e-12);
+}
+
+TEST(TSELLMatrix, multiplies_by_vector)
+{
+	expect_same_product(make_uneven(203, 150), 64);
+}
+
+TEST(TSELLMatrix, multiplies_without_sorting)
+{
+	expect_same_product(make_uneven(203, 150), 8);
+}
+
+TEST(TSELLMatrix, multiplies_in_parallel)
+{
+	// 8200 строк дают больше SELL_PARALLEL_SIZE порций
+	expect_same_product(make_uneven(8200, 300), 256);
+}
+
+TEST(TSELLMatrix, sorting_reduces_padding)
+{
+	TCSRMatrix<double> a = make_uneven(400, 200);
+	TSELLMatrix<double, 8> unsorted(a, 8), sorted(a, 400);
+	EXPECT_EQ(a.non_zeros(), sorted.non_zeros());
+	EXPECT_LT(sorted.stored_elements(), unsorted.stored_elements());
+	EXPECT_LE(size_t(a.non_zeros()), sorted.stored_elements());
+	EXPECT_GE(sorted.fill_ratio(), 1.0);
+}
+
+TEST(TSELLMatrix, sorts_rows_within_windows)
+{
+	TSELLMatrix<double, 4> s(make_uneven(50, 40), 16);
+	const int* perm = s.permutation_data();
+	for (int p = 0; p < 50; p++)
+		EXPECT_EQ(p / 16, perm[p] / 16);
+}
+
+TEST(TSELLMatrix, keeps_rows_in_place_when_sigma_equals_chunk)
+{
+	TSELLMatrix<double, 8> s(make_uneven(203, 150), 8);
+	const int* perm = s.permutation_data();
+	for (int p = 0; p < 203; p++)
+		EXPECT_EQ(p, perm[p]);
+}
+
+TEST(TSELLMatrix, throws_when_sigma_is_not_multiple_of_chunk)
+{
+	TCSRMatrix<double> a = make_uneven(20, 20);
+	ASSERT_ANY_THROW((TSELLMatrix<double, 8>(a, 12)));
+	ASSERT_ANY_THROW((TSELLMatrix<double, 8>(a, 0)));
+}
@@ -0,0 +1,292 @@
+#include "solvers.h"
+#include "test_helpers.h"
+
+#include <gtest.h>
+
+template<class Matrix>
+static double residual_norm(const Matrix& a, const TDynamicVector<double>& x, const TDynamicVector<double>& b)
+{
+	TDynamicVector<double> r = a * x - b;
+	return sqrt(r * r);
+}
+
+TEST(TGeneralBandMatrix, can_multiply_by_vector)
+{
+	TGeneralBandMatrix<int> m(4, 1, 2);
+	TDynamicMatrix<int> dense(4);
+	for (int i = 0; i < 4; i++)
+		for (int j = max(0, i - 1); j <= min(3, i + 2); j++) {
+			m(i, j) = 10 * i + j + 1;
+			dense[i][j] = 10 * i + j + 1;
+		}
+	TDynamicVector<int> v(4);
+	for (size_t i = 0; i < 4; i++)
+		v[i] = int(i) - 1;
+	EXPECT_EQ(dense * v, m * v);
+}
+
+TEST(TSymmetricBandMatrix, can_multiply_by_vector)
+{
+	TSymmetricBandMatrix<int> m(5, 2);
+	TDynamicMatrix<int> dense(5);
+	for (int i = 0; i < 5; i++)
+		for (int j = i; j <= min(4, i + 2); j++) {
+			m(i, j) = i + 2 * j + 1;
+			dense[i][j] = dense[j][i] = i + 2 * j + 1;
+		}
+	TDynamicVector<int> v(5);
+	for (size_t i = 0; i < 5; i++)
+		v[i] = 3 - int(i);
+	EXPECT_EQ(dense * v, m * v);
+}
+
+TEST(cg, solves_csr_system)
+{
+	const int n = 200;
+	TCSRMatrix<double> a = make_tridiagonal(n, -1.0, 2.0, -1.0);
+	TDynamicVector<double> b = make_rhs(n), x(n);
+	TSolverOptions opt;
+	opt.tolerance = 1e-10;
+	TSolverReport rep = cg(a, b, x, opt);
+	EXPECT_TRUE(rep.converged);
+	EXPECT_LE(rep.iterations, size_t(n));
+	EXPECT_LE(rep.residual, 1e-10);
+	EXPECT_LT(residual_norm(a, x, b), 1e-6 * sqrt(b * b));
+}
+
+TEST(cg, reports_true_residual_at_convergence)
+{
+	const int n = 300;
+	TCSRMatrix<double> a = make_tridiagonal(n, -1.0, 2.0, -1.0);
+	TDynamicVector<double> b = make_rhs(n), x(n);
+	TSolverOptions opt;
+	opt.tolerance = 1e-8;
+	TSolverReport rep = cg(a, b, x, opt);
+	double res = residual_norm(a, x, b) / sqrt(b * b);
+	EXPECT_TRUE(rep.converged);
+	EXPECT_NEAR(res, rep.residual, 1e-3 * res);
+	EXPECT_LE(res, opt.tolerance);
+}
+
+TEST(cg, solves_symmetric_band_system)
+{
+	const int n = 100;
+	TSymmetricBandMatrix<double> a(n, 2);
+	for (int i = 0; i < n; i++) {
+		a(i, i) = 6.0;
+		if (i + 1 < n)
+			a(i, i + 1) = -2.0;
+		if (i + 2 < n)
+			a(i, i + 2) = 1.0;
+	}
+	TDynamicVector<double> b = make_rhs(n), x(n);
+	TSolverReport rep = cg(a, b, x);
+	EXPECT_TRUE(rep.converged);
+	EXPECT_LT(residual_norm(a, x, b), 1e-6 * sqrt(b * b));
+}
+
+TEST(cg, records_history_of_each_iteration)
+{
+	TCSRMatrix<double> a = make_tridiagonal(50, -1.0, 2.0, -1.0);
+	TDynamicVector<double> b = make_rhs(50), x(50);
+	TSolverReport rep = cg(a, b, x);
+	ASSERT_EQ(rep.iterations, rep.history.size());
+	for (size_t k = 0; k < rep.history.size(); k++) {
+		EXPECT_EQ(k + 1, rep.history[k].iteration);
+		EXPECT_GE(rep.history[k].seconds, 0.0);
+	}
+	EXPECT_EQ(rep.residual, rep.history.back().residual);
+}
+
+TEST(cg, reserves_history_before_iterations)
+{
+	TCSRMatrix<double> a = make_tridiagonal(50, -1.0, 2.0, -1.0);
+	TDynamicVector<double> b = make_rhs(50), x(50);
+	TSolverOptions opt;
+	opt.max_iterations = 200;
+	TSolverReport rep = cg(a, b, x, opt);
+	EXPECT_GE(rep.history.capacity(), opt.max_iterations);
+	EXPECT_FALSE(rep.breakdown);
+}
+
+TEST(cg, stops_at_iteration_limit)
+{
+	TCSRMatrix<double> a = make_tridiagonal(100, -1.0, 2.0, -1.0);
+	TDynamicVector<double> b = make_rhs(100), x(100);
+	TSolverOptions opt;
+	opt.max_iterations = 5;
+	opt.record_history = false;
+	TSolverReport rep = cg(a, b, x, opt);
+	EXPECT_FALSE(rep.converged);
+	EXPECT_EQ(5, rep.iterations);
+	EXPECT_TRUE(rep.history.empty());
+}
+
+TEST(cg, uses_initial_guess)
+{
+	TCSRMatrix<double> a = make_tridiagonal(30, -1.0, 2.0, -1.0);
+	TDynamicVector<double> b = make_rhs(30), x(30);
+	cg(a, b, x);
+	TSolverReport rep = cg(a, b, x);
+	EXPECT_TRUE(rep.converged);
+	EXPECT_EQ(0, rep.iterations);
+}
+
+TEST(cg, returns_zero_for_zero_rhs)
+{
+	TCSRMatrix<double> a = make_tridiagonal(10, -1.0, 2.0, -1.0);
+	TDynamicVector<double> b(10), x(10);
+	x[3] = 5.0;
+	TSolverReport rep = cg(a, b, x);
+	EXPECT_TRUE(rep.converged);
+	EXPECT_EQ(TDynamicVector<double>(10), x);
+}
+
+TEST(cg, throws_when_sizes_dont_match)
+{
+	TCSRMatrix<double> a = make_tridiagonal(10, -1.0, 2.0, -1.0);
+	TDynamicVector<double> b(10), x(9);
+	ASSERT_ANY_THROW(cg(a, b, x));
+}
+
+// Разностная схема для конвекции-диффузии: несимметричная трехдиагональная матрица
+static TCSRMatrix<double> make_convection_csr(int n, double c)
+{
+	return make_tridiagonal(n, -1.0 - c, 2.5, -1.0 + c);
+}
+
+TEST(bicgstab, solves_nonsymmetric_system)
+{
+	const int n = 300;
+	TCSRMatrix<double> a = make_convection_csr(n, 0.4);
+	TDynamicVector<double> b = make_rhs(n), x(n);
+	TSolverOptions opt;
+	opt.tolerance = 1e-10;
+	TSolverReport rep = bicgstab(a, b, x, opt);
+	EXPECT_TRUE(rep.converged);
+	EXPECT_EQ(rep.iterations, rep.history.size());
+	EXPECT_LT(residual_norm(a, x, b), 1e-8 * sqrt(b * b));
+}
+
+TEST(bicgstab, stops_at_iteration_limit)
+{
+	TCSRMatrix<double> a = make_convection_csr(300, 0.4);
+	TDynamicVector<double> b = make_rhs(300), x(300);
+	TSolverOptions opt;
+	opt.tolerance = 1e-14;
+	opt.max_iterations = 3;
+	TSolverReport rep = bicgstab(a, b, x, opt);
+	EXPECT_FALSE(rep.converged);
+	EXPECT_EQ(3, rep.iterations);
+}
+
+TEST(gmres, solves_nonsymmetric_system_with_restarts)
+{
+	const int n = 300;
+	TCSRMatrix<double> a = make_convection_csr(n, 0.4);
+	TDynamicVector<double> b = make_rhs(n), x(n);
+	TSolverOptions opt;
+	opt.tolerance = 1e-10;
+	opt.restart = 10;
+	TSolverReport rep = gmres(a, b, x, opt);
+	EXPECT_TRUE(rep.converged);
+	EXPECT_GT(rep.iterations, opt.restart);
+	EXPECT_LT(residual_norm(a, x, b), 1e-8 * sqrt(b * b));
+}
+
+TEST(gmres, residual_does_not_grow_within_cycle)
+{
+	TCSRMatrix<double> a = make_convection_csr(100, 0.6);
+	TDynamicVector<double> b = make_rhs(100), x(100);
+	TSolverOptions opt;
+	opt.restart = 100;
+	TSolverReport rep = gmres(a, b, x, opt);
+	ASSERT_TRUE(rep.converged);
+	for (size_t k = 1; k < rep.history.size(); k++)
+		EXPECT_LE(rep.history[k].residual, rep.history[k - 1].residual * (1 + 1e-12));
+}
+
+TEST(gmres, is_exact_when_restart_equals_size)
+{
+	const int n = 20;
+	TCSRMatrix<double> a = make_convection_csr(n, 0.9);
+	TDynamicVector<double> b = make_rhs(n), x(n);
+	TSolverOptions opt;
+	opt.restart = n;
+	opt.tolerance = 1e-12;
+	TSolverReport rep = gmres(a, b, x, opt);
+	EXPECT_TRUE(rep.converged);
+	EXPECT_LE(rep.iterations, size_t(n));
+}
+
+TEST(gmres, reports_breakdown_on_singular_hessenberg_matrix)
+{
+	// A e_0 = 0: первый шаг Арнольди дает нулевой столбец H
+	TCSRMatrix<double> a(2, 2);
+	a.set(1, 1, 1.0);
+	TDynamicVector<double> b(2), x(2);
+	b[0] = 1.0;
+	TSolverReport rep = gmres(a, b, x);
+	EXPECT_TRUE(rep.breakdown);
+	EXPECT_FALSE(rep.converged);
+	EXPECT_EQ(1, rep.iterations);
+	EXPECT_EQ(1.0, rep.residual);
+	EXPECT_EQ(0.0, x[0]);
+	EXPECT_EQ(0.0, x[1]);
+}
+
+TEST(gmres, throws_when_restart_is_zero)
+{
+	TCSRMatrix<double> a = make_convection_csr(10, 0.1);
+	TDynamicVector<double> b = make_rhs(10), x(10);
+	TSolverOptions opt;
+	opt.restart = 0;
+	ASSERT_ANY_THROW(gmres(a, b, x, opt));
+}
+
+// Система, длина которой больше SOLVER_PARALLEL_SIZE, а число ненулевых
+// больше CSR_SPMV_PARALLEL_SIZE
+TEST(cg, solves_large_system_in_parallel)
+{
+	const int n = 6000;
+	TCSRMatrix<double> a = make_convection_csr(n, 0.0);
+	ASSERT_GE(size_t(a.non_zeros()), CSR_SPMV_PARALLEL_SIZE);
+	TDynamicVector<double> b = make_rhs(n), x(n);
+	TSolverReport rep = cg(a, b, x);
+	EXPECT_TRUE(rep.converged);
+	EXPECT_LT(residual_norm(a, x, b), 1e-6 * sqrt(b * b));
+}
+
+TEST(bicgstab, solves_large_system_in_parallel)
+{
+	const int n = 6000;
+	TCSRMatrix<double> a = make_convection_csr(n, 0.4);
+	TDynamicVector<double> b = make_rhs(n), x(n);
+	TSolverReport rep = bicgstab(a, b, x);
+	EXPECT_TRUE(rep.converged);
+	EXPECT_LT(residual_norm(a, x, b), 1e-6 * sqrt(b * b));
+}
+
+TEST(gmres, solves_large_system_in_parallel)
+{
+	const int n = 6000;
+	TCSRMatrix<double> a = make_convection_csr(n, 0.4);
+	TDynamicVector<double> b = make_rhs(n), x(n);
+	TSolverReport rep = gmres(a, b, x);
+	EXPECT_TRUE(rep.converged);
+	EXPECT_LT(residual_norm(a, x, b), 1e-6 * sqrt(b * b));
+}
+
+TEST(TKrylovWorkspace, is_reused_between_solves)
+{
+	TCSRMatrix<double> a = make_convection_csr(200, 0.3);
+	TDynamicVector<double> b = make_rhs(200);
+	TKrylovWorkspace<double> ws;
+	TDynamicVector<double> x1(200), x2(200);
+	gmres(a, b, x1, ws);
+	size_t cap = ws.capacity();
+	gmres(a, b, x2, ws);
+	bicgstab(a, b, x2, ws);
+	EXPECT_EQ(cap, ws.capacity());
+	EXPECT_LT(residual_norm(a, x2, b), 1e-6 * sqrt(b * b));
+}
@@ -0,0 +1,123 @@
+#include "sparse_vector.h"
+
+#include <gtest.h>
+
+static TSparseVector<double> make_sparse(size_t n, size_t step, size_t shift)
+{
+	TSparseVector<double> v(n);
+	for (size_t i = shift; i < n; i += step)
+		v.push_back(int(i), double(i % 7) - 2.5);
+	return v;
+}
+
+static TCSRMatrix<double> make_matrix(int rows, int cols)
+{
+	TCSRMatrix<double> a(rows, cols);
+	for (int i = 0; i < rows; i++)
+		for (int s = 0; s < 3; s++)
+			a.set(i, (i * 3 + s * 11) % cols, double(s + 1) - 0.5 * double(i % 4));
+	return a;
+}
+
+TEST(TSparseVector, converts_to_and_from_dense)
+{
+	TDynamicVector<double> d(10);
+	d[2] = 1.5;
+	d[7] = -3.0;
+	d[8] = 1e-14;
+	TSparseVector<double> s(d, 1e-12);
+	EXPECT_EQ(2, s.non_zeros());
+	EXPECT_EQ(-3.0, s[7]);
+	EXPECT_EQ(0.0, s[8]);
+	d[8] = 0.0;
+	EXPECT_EQ(d, s.to_dense());
+}
+
+TEST(TSparseVector, throws_on_unsorted_indices)
+{
+	TSparseVector<double> s(5);
+	s.push_back(3, 1.0);
+	ASSERT_ANY_THROW(s.push_back(1, 1.0));
+	TTrackedVector<int> idx = { 0, 4, 2 };
+	TTrackedVector<double> val = { 1.0, 2.0, 3.0 };
+	ASSERT_ANY_THROW(TSparseVector<double>(5, move(idx), move(val)));
+}
+
+TEST(TSparseVector, computes_sparse_dot_product)
+{
+	TSparseVector<double> a = make_sparse(1000, 3, 0), b = make_sparse(1000, 5, 0);
+	EXPECT_EQ(a.to_dense() * b.to_dense(), a * b);
+}
+
+TEST(TSparseVector, computes_dot_product_with_much_shorter_vector)
+{
+	// второй вектор в SPARSE_GALLOP_RATIO раз короче и ищется двоичным поиском
+	TSparseVector<double> a = make_sparse(5000, 1, 0), b = make_sparse(5000, 97, 13);
+	EXPECT_EQ(a.to_dense() * b.to_dense(), a * b);
+	EXPECT_EQ(a.to_dense() * b.to_dense(), b * a);
+}
+
+TEST(TSparseVector, computes_dot_product_with_dense_vector)
+{
+	TSparseVector<double> a = make_sparse(200, 7, 3);
+	TDynamicVector<double> d(200);
+	for (size_t i = 0; i < 200; i++)
+		d[i] = double(i % 5);
+	EXPECT_EQ(a.to_dense() * d, a * d);
+	EXPECT_EQ(a.to_dense() * d, d * a);
+}
+
+TEST(TSparseVector, adds_scaled_vector_into_dense)
+{
+	TSparseVector<double> x = make_sparse(50, 4, 1);
+	TDynamicVector<double> y(50), expected(50);
+	for (size_t i = 0; i < 50; i++)
+		y[i] = expected[i] = 1.0;
+	axpy(2.0, x, y);
+	TDynamicVector<double> dx = x.to_dense();
+	for (size_t i = 0; i < 50; i++)
+		EXPECT_EQ(expected[i] + 2.0 * dx[i], y[i]);
+}
+
+TEST(TSparseVector, multiplies_csc_matrix_by_sparse_vector)
+{
+	TCSRMatrix<double> a = make_matrix(120, 90);
+	TCSCMatrix<double> c(a);
+	TSparseVector<double> x = make_sparse(90, 17, 2);
+	TSpMSpVWorkspace<double> ws;
+	TSparseVector<double> y = spmspv(c, x, ws);
+	TDynamicVector<double> expected = a * x.to_dense();
+	EXPECT_EQ(expected, y.to_dense());
+	EXPECT_LT(y.non_zeros(), size_t(120));
+	// рабочая область после умножения снова нулевая
+	EXPECT_EQ(y, spmspv(c, x, ws));
+}
+
+TEST(TSparseVector, multiplies_csr_matrix_by_sparse_vector)
+{
+	TCSRMatrix<double> a = make_matrix(120, 90);
+	TSparseVector<double> x = make_sparse(90, 17, 2);
+	EXPECT_EQ(TCSCMatrix<double>(a) * x, a * x);
+}
+
+TEST(TSparseVector, reuses_workspace_for_matrices_of_different_sizes)
+{
+	// у большой матрицы ненулевых больше CSR_SPMV_PARALLEL_SIZE
+	TCSRMatrix<double> big = make_matrix(6000, 5000), small = make_matrix(120, 90);
+	ASSERT_GE(size_t(big.non_zeros()), CSR_SPMV_PARALLEL_SIZE);
+	TSparseVector<double> xb = make_sparse(5000, 7, 3), xs = make_sparse(90, 17, 2);
+	TSpMSpVWorkspace<double> ws;
+	TSparseVector<double> yb = spmspv(big, xb, ws);
+	EXPECT_EQ(big * xb.to_dense(), yb.to_dense());
+	EXPECT_EQ(small * xs.to_dense(), spmspv(small, xs, ws).to_dense());
+	EXPECT_EQ(yb, spmspv(TCSCMatrix<double>(big), xb, ws));
+	EXPECT_EQ(yb, spmspv(big, xb, ws));
+}
+
+TEST(TSparseVector, throws_when_sizes_dont_match)
+{
+	TSparseVector<double> a(5), b(6);
+	ASSERT_ANY_THROW(a * b);
+	TCSRMatrix<double> m(4, 6);
+	ASSERT_ANY_THROW(m * a);
+}
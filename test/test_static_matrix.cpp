@@ -0,0 +1,70 @@
+#include "static_matrix.h"
+
+#include <gtest.h>
+
+constexpr TStaticMatrix<int, 2, 2> make_static_matrix(int a, int b, int c, int d)
+{
+	TStaticMatrix<int, 2, 2> m;
+	m[0][0] = a; m[0][1] = b;
+	m[1][0] = c; m[1][1] = d;
+	return m;
+}
+
+TEST(TStaticVector, is_zero_initialized)
+{
+	TStaticVector<int, 4> v;
+	for (size_t i = 0; i < v.size(); i++)
+		EXPECT_EQ(0, v[i]);
+}
+
+TEST(TStaticVector, throws_when_index_out_of_range)
+{
+	TStaticVector<int, 3> v;
+	ASSERT_ANY_THROW(v.at(3) = 1);
+}
+
+TEST(TStaticVector, can_add_and_multiply_vectors)
+{
+	TStaticVector<int, 3> v1, v2, expected;
+	v1[0] = 1; v1[1] = 2; v1[2] = 3;
+	v2[0] = 4; v2[1] = 5; v2[2] = 6;
+	expected[0] = 5; expected[1] = 7; expected[2] = 9;
+	EXPECT_EQ(expected, v1 + v2);
+	EXPECT_EQ(32, v1 * v2);
+}
+
+TEST(TStaticMatrix, can_multiply_matrices)
+{
+	TStaticMatrix<int, 2, 2> m1 = make_static_matrix(1, 2, 3, 4);
+	TStaticMatrix<int, 2, 2> m2 = make_static_matrix(2, 0, 1, 2);
+	EXPECT_EQ(make_static_matrix(4, 4, 10, 8), m1 * m2);
+}
+
+TEST(TStaticMatrix, can_multiply_rectangular_matrices)
+{
+	TStaticMatrix<int, 2, 3> a;
+	TStaticMatrix<int, 3, 1> b;
+	a[0][0] = 1; a[0][1] = 2; a[0][2] = 3;
+	a[1][0] = 4; a[1][1] = 5; a[1][2] = 6;
+	b[0][0] = 1; b[1][0] = 1; b[2][0] = 1;
+	TStaticMatrix<int, 2, 1> c = a * b;
+	EXPECT_EQ(6, c[0][0]);
+	EXPECT_EQ(15, c[1][0]);
+}
+
+TEST(TStaticMatrix, can_multiply_matrix_by_vector)
+{
+	TStaticMatrix<int, 2, 2> m = make_static_matrix(1, 2, 3, 4);
+	TStaticVector<int, 2> v, expected;
+	v[0] = 2; v[1] = 3;
+	expected[0] = 8; expected[1] = 18;
+	EXPECT_EQ(expected, m * v);
+}
+
+TEST(TStaticMatrix, operations_are_constexpr)
+{
+	constexpr TStaticMatrix<int, 2, 2> m = make_static_matrix(1, 2, 3, 4) + make_static_matrix(1, 1, 1, 1);
+	static_assert(m[1][1] == 5, "constexpr addition");
+	static_assert((m * m).transpose()[0][1] == 4 * 2 + 5 * 4, "constexpr multiplication");
+	EXPECT_EQ(5, m[1][1]);
+}
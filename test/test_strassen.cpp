@@ -0,0 +1,59 @@
+#include "strassen.h"
+
+#include <gtest.h>
+
+static TDynamicMatrix<int> make_test_matrix(size_t n, int seed)
+{
+	TDynamicMatrix<int> m(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			m[i][j] = static_cast<int>((i * 7 + j * 3 + seed) % 11) - 5;
+	return m;
+}
+
+static TDynamicMatrix<int> naive_multiply(const TDynamicMatrix<int>& a, const TDynamicMatrix<int>& b)
+{
+	size_t n = a.size();
+	TDynamicMatrix<int> c(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			for (size_t k = 0; k < n; k++)
+				c[i][j] += a[i][k] * b[k][j];
+	return c;
+}
+
+TEST(TDynamicMatrix, blocked_multiply_matches_naive_for_size_larger_than_block)
+{
+	TDynamicMatrix<int> a = make_test_matrix(300, 1), b = make_test_matrix(300, 2);
+	EXPECT_EQ(naive_multiply(a, b), a * b);
+}
+
+TEST(Strassen, matches_classical_multiply_for_power_of_two_size)
+{
+	TDynamicMatrix<int> a = make_test_matrix(64, 1), b = make_test_matrix(64, 2);
+	EXPECT_EQ(naive_multiply(a, b), strassen_multiply(a, b, 4));
+}
+
+TEST(Strassen, matches_classical_multiply_for_odd_size)
+{
+	TDynamicMatrix<int> a = make_test_matrix(45, 3), b = make_test_matrix(45, 4);
+	EXPECT_EQ(naive_multiply(a, b), strassen_multiply(a, b, 4));
+}
+
+TEST(Strassen, uses_classical_kernel_below_cutoff)
+{
+	TDynamicMatrix<int> a = make_test_matrix(10, 5), b = make_test_matrix(10, 6);
+	EXPECT_EQ(naive_multiply(a, b), strassen_multiply(a, b));
+}
+
+TEST(Strassen, workspace_is_zero_below_cutoff)
+{
+	EXPECT_EQ(0, strassen_workspace(100, 128));
+	EXPECT_EQ(2 * 64 * 64, strassen_workspace(128, 64));
+}
+
+TEST(Strassen, throws_when_sizes_dont_match)
+{
+	TDynamicMatrix<int> a(3), b(4);
+	ASSERT_ANY_THROW(strassen_multiply(a, b));
+}
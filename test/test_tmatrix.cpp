@@ -1,6 +1,7 @@
 #include "tmatrix.h"
 #include "dop_matrix.h"
 #include <gtest.h>
+#include <sstream>
 
 TEST(TDynamicMatrix, can_create_matrix_with_positive_length) //
 {
@@ -359,6 +360,43 @@ TEST(TCSRMatrix, operator_access_works_like_get)
 }
 
 
+TEST(TCSRMatrix, prints_coordinate_triplets)
+{
+	TCSRMatrix<int> m(3, 3);
+	m.set(0, 1, 5);
+	m.set(2, 0, 7);
+	ostringstream ostr;
+	m.print(ostr);
+	EXPECT_EQ("0 1 5\n2 0 7\n", ostr.str());
+}
+
+TEST(TCSRMatrix, prints_raw_csr_arrays)
+{
+	TCSRMatrix<int> m(2, 3);
+	m.set(0, 2, 4);
+	m.set(1, 0, 9);
+	ostringstream ostr;
+	m.print(ostr, TCSROutput::Arrays);
+	EXPECT_EQ("row_index: 0 1 2\ncol_indices: 2 0\nvalues: 4 9\n", ostr.str());
+}
+
+TEST(TCSRMatrix, prints_dense_table_on_request)
+{
+	TCSRMatrix<int> m(2, 2);
+	m.set(0, 1, 3);
+	ostringstream ostr;
+	m.print(ostr, TCSROutput::Dense);
+	EXPECT_EQ("0 3 \n0 0 \n", ostr.str());
+}
+
+TEST(TCSRMatrix, dense_print_is_limited_by_size)
+{
+	TCSRMatrix<int> m(100, 100);
+	ostringstream ostr;
+	ASSERT_ANY_THROW(m.print(ostr, TCSROutput::Dense, 1000));
+}
+
+
 /*
 TEST(TDynamicMatrix, cant_create_too_large_matrix)
 {
@@ -366,3 +404,396 @@ TEST(TDynamicMatrix, cant_create_too_large_matrix)
 }
 */
 
+
+TEST(TDynamicMatrix, can_transpose_matrix)
+{
+	TDynamicMatrix<int> m(2), expected(2);
+	m[0][0] = 1; m[0][1] = 2;
+	m[1][0] = 3; m[1][1] = 4;
+	expected[0][0] = 1; expected[0][1] = 3;
+	expected[1][0] = 2; expected[1][1] = 4;
+	EXPECT_EQ(expected, m.transpose());
+}
+
+TEST(TDynamicMatrix, transpose_of_large_matrix_is_correct)
+{
+	const size_t n = 101;
+	TDynamicMatrix<int> m(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			m[i][j] = static_cast<int>(i * n + j);
+	TDynamicMatrix<int> t = m.transpose();
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			EXPECT_EQ(m[i][j], t[j][i]);
+}
+
+TEST(TDynamicMatrix, inplace_transpose_matches_out_of_place)
+{
+	const size_t n = 77;
+	TDynamicMatrix<int> m(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			m[i][j] = static_cast<int>(i * 3 + j * 1000);
+	TDynamicMatrix<int> t = m.transpose();
+	m.transpose_inplace();
+	EXPECT_EQ(t, m);
+}
+
+static TDynamicMatrix<int> make_lazy_matrix(size_t n, int seed)
+{
+	TDynamicMatrix<int> m(n);
+	for (size_t i = 0; i < n; i++)
+		for (size_t j = 0; j < n; j++)
+			m[i][j] = static_cast<int>((i * 5 + j * 3 + seed) % 9) - 4;
+	return m;
+}
+
+TEST(TDynamicMatrix, transposed_times_matrix_matches_explicit_transpose)
+{
+	TDynamicMatrix<int> a = make_lazy_matrix(70, 1), b = make_lazy_matrix(70, 2);
+	EXPECT_EQ(a.transpose() * b, transposed(a) * b);
+}
+
+TEST(TDynamicMatrix, matrix_times_transposed_matches_explicit_transpose)
+{
+	TDynamicMatrix<int> a = make_lazy_matrix(300, 3), b = make_lazy_matrix(300, 4);
+	EXPECT_EQ(a * b.transpose(), a * transposed(b));
+}
+
+TEST(TDynamicMatrix, transposed_times_vector_matches_explicit_transpose)
+{
+	TDynamicMatrix<int> a = make_lazy_matrix(9, 5);
+	TDynamicVector<int> x(9);
+	for (size_t i = 0; i < 9; i++)
+		x[i] = static_cast<int>(i) - 3;
+	EXPECT_EQ(a.transpose() * x, transposed(a) * x);
+}
+
+TEST(TCSRMatrix, can_multiply_by_vector)
+{
+	TCSRMatrix<int> m(2, 3);
+	m.set(0, 0, 1); m.set(0, 2, 2);
+	m.set(1, 1, 3);
+	TDynamicVector<int> x(3), expected(2);
+	x[0] = 1; x[1] = 2; x[2] = 3;
+	expected[0] = 7; expected[1] = 6;
+	EXPECT_EQ(expected, m * x);
+}
+
+TEST(TCSRMatrix, transposed_can_multiply_by_vector)
+{
+	TCSRMatrix<int> m(2, 3);
+	m.set(0, 0, 1); m.set(0, 2, 2);
+	m.set(1, 1, 3);
+	TDynamicVector<int> x(2), expected(3);
+	x[0] = 2; x[1] = 5;
+	expected[0] = 2; expected[1] = 15; expected[2] = 4;
+	EXPECT_EQ(expected, transposed(m) * x);
+}
+
+TEST(TCSRMatrix, throws_when_vector_size_dont_match)
+{
+	TCSRMatrix<int> m(2, 3);
+	TDynamicVector<int> x(2);
+	ASSERT_ANY_THROW(m * x);
+}
+
+TEST(TCSRMatrix, can_multiply_matrices)
+{
+	TCSRMatrix<int> a(2, 3), b(3, 2);
+	a.set(0, 0, 1); a.set(0, 2, 2);
+	a.set(1, 1, 3);
+	b.set(0, 1, 4); b.set(1, 0, 5);
+	b.set(2, 0, 6); b.set(2, 1, 7);
+	TCSRMatrix<int> c = a * b;
+	EXPECT_EQ(3, c.non_zeros());
+	EXPECT_EQ(12, c(0, 0));
+	EXPECT_EQ(18, c(0, 1));
+	EXPECT_EQ(15, c(1, 0));
+	EXPECT_EQ(0, c(1, 1));
+	ASSERT_ANY_THROW(a * a);
+}
+
+TEST(TCSRMatrix, product_drops_cancelled_elements)
+{
+	TCSRMatrix<int> a(2, 2), b(2, 2);
+	a.set(0, 0, 1); a.set(0, 1, 1);
+	a.set(1, 1, 2);
+	b.set(0, 0, 3); b.set(1, 0, -3);
+	b.set(1, 1, 1);
+	TCSRMatrix<int> c = a * b;
+	// c_00 = 3 - 3    
+	EXPECT_EQ(3, c.non_zeros());
+	EXPECT_EQ(0, c(0, 0));
+	EXPECT_EQ(1, c(0, 1));
+	EXPECT_EQ(-6, c(1, 0));
+	EXPECT_EQ(2, c(1, 1));
+}
+
+TEST(TCSRMatrix, multiplies_matrices_with_skewed_rows_in_parallel)
+{
+	//  i   n / (i + 1) ,    
+	//  ; (A A) x   A (A x)
+	const int n = 3000;
+	TTrackedVector<int> ptr(n + 1, 0), col;
+	TTrackedVector<double> val;
+	for (int i = 0; i < n; i++) {
+		int len = 1 + n / (i + 1) / 4;
+		for (int s = 0; s < len; s++) {
+			col.push_back((i + s * 7) % n);
+			val.push_back(double((i + s) % 5) - 2.0);
+		}
+		sort(col.begin() + ptr[i], col.end());
+		col.erase(unique(col.begin() + ptr[i], col.end()), col.end());
+		val.resize(col.size());
+		ptr[i + 1] = int(col.size());
+	}
+	TCSRMatrix<double> a(n, n, move(ptr), move(col), move(val));
+	TCSRMatrix<double> c = a * a;
+	TDynamicVector<double> x(n);
+	for (int i = 0; i < n; i++)
+		x[i] = double(i % 9) - 4.0;
+	TDynamicVector<double> y = c * x, z = a * (a * x);
+	for (int i = 0; i < n; i++)
+		EXPECT_NEAR(z[i], y[i], 1e-9);
+	const int* cp = c.row_index_data();
+	const int* cc = c.col_indices_data();
+	for (int i = 0; i < n; i++)
+		for (int k = cp[i] + 1; k < cp[i + 1]; k++)
+			ASSERT_LT(cc[k - 1], cc[k]);
+}
+
+TEST(prefix_sum, sums_across_chunks)
+{
+	vector<int> a(3 * PREFIX_SUM_CHUNK + 5, 1);
+	prefix_sum(a.data(), a.size());
+	for (size_t i = 0; i < a.size(); i++)
+		ASSERT_EQ(int(i + 1), a[i]);
+	vector<int> big(2, numeric_limits<int>::max());
+	ASSERT_ANY_THROW(prefix_sum(big.data(), big.size()));
+}
+
+//  float 1e8 + 1    1e8,  double  :
+//     1e8  m 
+TEST(TDynamicVector, dot_accumulates_in_wider_type)
+{
+	const size_t m = 1000;
+	TDynamicVector<float> a(m + 1), b(m + 1);
+	for (size_t i = 0; i <= m; i++)
+		a[i] = b[i] = 1.0f;
+	a[0] = 1e8f;
+	EXPECT_EQ(1e8f, a * b);
+	EXPECT_EQ(1e8 + m, a.dot<double>(b));
+}
+
+TEST(TDynamicMatrix, multiplies_by_vector_with_wider_accumulator)
+{
+	const size_t n = 100;
+	TDynamicMatrix<float> a(n);
+	TDynamicVector<float> x(n);
+	for (size_t i = 0; i < n; i++) {
+		x[i] = 1.0f;
+		for (size_t j = 0; j < n; j++)
+			a[i][j] = 1.0f;
+	}
+	a[0][0] = 1e8f;
+	TDynamicVector<double> y = a.multiply<double>(x);
+	EXPECT_EQ(1e8f, (a * x)[0]);
+	EXPECT_EQ(1e8 + (n - 1), y[0]);
+	EXPECT_EQ(double(n), y[1]);
+}
+
+TEST(TGeneralBandMatrix, multiplies_by_vector_with_wider_accumulator)
+{
+	const int n = 200, m = 100;
+	TGeneralBandMatrix<float> a(n, 1, m);
+	for (int offset = -1; offset <= m; offset++)
+		for (int p = 0; p < n - abs(offset); p++)
+			a.diagonal_data(offset)[p] = 1.0f;
+	a.diagonal_data(0)[0] = 1e8f;
+	TDynamicVector<float> x(n);
+	for (int i = 0; i < n; i++)
+		x[i] = 1.0f;
+	TDynamicVector<double> y = a.multiply<double>(x);
+	EXPECT_EQ(1e8f, (a * x)[0]);
+	EXPECT_EQ(1e8 + m, y[0]);
+	EXPECT_EQ(double(m + 2), y[1]);
+}
+
+TEST(TSymmetricBandMatrix, multiplies_by_vector_with_wider_accumulator)
+{
+	const int n = 200, m = 100;
+	TSymmetricBandMatrix<float> a(n, m);
+	for (int offset = 0; offset <= m; offset++)
+		for (int p = 0; p < n - offset; p++)
+			a.diagonal_data(offset)[p] = 1.0f;
+	a.diagonal_data(0)[0] = 1e8f;
+	TDynamicVector<float> x(n);
+	for (int i = 0; i < n; i++)
+		x[i] = 1.0f;
+	TDynamicVector<double> y = a.multiply<double>(x);
+	EXPECT_EQ(1e8f, (a * x)[0]);
+	EXPECT_EQ(1e8 + m, y[0]);
+	EXPECT_EQ(double(m + 2), y[1]);
+}
+
+TEST(TCSRMatrix, multiplies_by_vector_with_wider_accumulator)
+{
+	const int n = 1000;
+	TTrackedVector<int> ptr = { 0, n }, col(n);
+	TTrackedVector<float> val(n, 1.0f);
+	for (int j = 0; j < n; j++)
+		col[j] = j;
+	val[0] = 1e8f;
+	TCSRMatrix<float> a(1, n, move(ptr), move(col), move(val));
+	TDynamicVector<float> x(n);
+	for (int j = 0; j < n; j++)
+		x[j] = 1.0f;
+	double y = 0.0;
+	a.multiply(x.data(), &y);
+	EXPECT_EQ(1e8f, (a * x)[0]);
+	EXPECT_EQ(1e8 + (n - 1), y);
+	EXPECT_EQ(y, a.multiply<double>(x)[0]);
+}
+
+TEST(TDynamicMatrix, memory_bytes_counts_row_buffers)
+{
+	TDynamicVector<double> v(1000);
+	EXPECT_LE(sizeof(v) + 1000 * sizeof(double), v.memory_bytes());
+	TDynamicMatrix<double> m(100);
+	EXPECT_LE(sizeof(m) + 100 * (sizeof(TDynamicVector<double>) + 100 * sizeof(double)), m.memory_bytes());
+}
+
+TEST(TGeneralBandMatrix, memory_bytes_includes_dense_storage)
+{
+	TGeneralBandMatrix<double> a(200, 1, 1);
+	TTriangleBandMatrix<double> t(200, 1);
+	//      ,   
+	EXPECT_LE(200 * 200 * sizeof(double), a.memory_bytes());
+	EXPECT_LE(200 * 200 * sizeof(double), t.memory_bytes());
+	EXPECT_LT(a.memory_bytes() - TDynamicMatrix<double>(200).memory_bytes(), 4 * 200 * sizeof(double));
+}
+
+TEST(TCSRMatrix, memory_bytes_counts_capacity)
+{
+	TCSRMatrix<double> a(100, 100);
+	for (int i = 0; i < 100; i++)
+		a.set(i, i, 1.0);
+	size_t grown = a.memory_bytes();
+	EXPECT_LE(sizeof(a) + 100 * (sizeof(double) + sizeof(int)) + 101 * sizeof(int), grown);
+	a.shrink_to_fit();
+	EXPECT_LE(a.memory_bytes(), grown);
+	EXPECT_EQ(100, a.non_zeros());
+}
+
+TEST(library_live_bytes, follows_allocations_and_releases)
+{
+	size_t before = library_live_bytes();
+	{
+		TDynamicMatrix<double> m(50);
+		TCSRMatrix<double> a(50, 50);
+		a.set(3, 4, 1.0);
+		EXPECT_LE(50 * 50 * sizeof(double), library_live_bytes() - before);
+		EXPECT_EQ(m.memory_bytes() - sizeof(m) + a.memory_bytes() - sizeof(a), library_live_bytes() - before);
+	}
+	EXPECT_EQ(before, library_live_bytes());
+}
+
+TEST(TCSRMatrix, can_convert_from_dense_with_drop_tolerance)
+{
+	TDynamicMatrix<double> m(3);
+	m[0][0] = 1.0; m[0][2] = 1e-12;
+	m[1][1] = -2.0; m[1][0] = 3.0;
+	m[2][2] = 4.0;
+	TCSRMatrix<double> a(m, 1e-10);
+	EXPECT_EQ(4, a.non_zeros());
+	EXPECT_EQ(3.0, a(1, 0));
+	EXPECT_EQ(0.0, a(0, 2));
+	EXPECT_EQ(5, TCSRMatrix<double>(m).non_zeros());
+}
+
+TEST(TCSRMatrix, dense_round_trip_preserves_large_matrix)
+{
+	const int n = 300;
+	TDynamicMatrix<double> m(n);
+	for (int i = 0; i < n; i++)
+		for (int j = max(0, i - 2); j < min(n, i + 5); j++)
+			m[i][j] = double((i * 7 + j) % 11) - 5.0;
+	TCSRMatrix<double> a(m);
+	EXPECT_EQ(m, a.to_dense());
+}
+
+TEST(TCSRMatrix, to_band_detects_bandwidth)
+{
+	TCSRMatrix<double> a(5, 5);
+	for (int i = 0; i < 5; i++)
+		a.set(i, i, 2.0);
+	a.set(4, 2, -1.0);
+	a.set(0, 1, 3.0);
+	TGeneralBandMatrix<double> b = a.to_band();
+	EXPECT_EQ(2, b.lower_band());
+	EXPECT_EQ(1, b.upper_band());
+	EXPECT_EQ(-1.0, b(4, 2));
+	EXPECT_EQ(3.0, b(0, 1));
+	EXPECT_EQ(0.0, b(3, 1));
+	EXPECT_EQ(a.to_dense(), b.to_dense());
+}
+
+TEST(TCSRMatrix, to_band_doesnt_allocate_dense_storage)
+{
+	const int n = 500;
+	TCSRMatrix<double> a(n, n);
+	for (int i = 0; i < n; i++) {
+		a.set(i, i, 2.0);
+		if (i > 0)
+			a.set(i, i - 1, -1.0);
+	}
+	TGeneralBandMatrix<double> b = a.to_band();
+	//      n x n
+	EXPECT_LT(b.memory_bytes(), 4 * n * sizeof(double) + 4096);
+	EXPECT_EQ(a.to_dense(), b.to_dense());
+	TGeneralBandMatrix<double> c = b;
+	c(3, 2) = 5.0;
+	EXPECT_EQ(-1.0, b(3, 2));
+	TDynamicVector<double> x(n);
+	for (int i = 0; i < n; i++)
+		x[i] = 1.0 + i % 3;
+	EXPECT_EQ(a * x, b * x);
+}
+
+TEST(TCSRMatrix, can_convert_from_band)
+{
+	TGeneralBandMatrix<double> b(6, 1, 2);
+	for (int i = 0; i < 6; i++) {
+		b(i, i) = 1.0 + i;
+		if (i + 2 < 6)
+			b(i, i + 2) = -1.0;
+	}
+	TCSRMatrix<double> a(b);
+	//         
+	EXPECT_EQ(6 + 4, a.non_zeros());
+	EXPECT_EQ(b.to_dense(), a.to_dense());
+}
+
+TEST(TCSRMatrix, conversion_from_symmetric_band_mirrors_upper_part)
+{
+	TSymmetricBandMatrix<double> b(4, 1);
+	for (int i = 0; i < 4; i++)
+		b(i, i) = 2.0;
+	for (int i = 0; i < 3; i++)
+		b(i, i + 1) = -1.0;
+	TCSRMatrix<double> a(b);
+	EXPECT_EQ(4 + 2 * 3, a.non_zeros());
+	EXPECT_EQ(-1.0, a(2, 1));
+	TDynamicMatrix<double> d = b.to_dense();
+	EXPECT_EQ(-1.0, d[3][2]);
+	EXPECT_EQ(d, a.to_dense());
+}
+
+TEST(TCSRMatrix, throws_when_converting_rectangular_matrix)
+{
+	TCSRMatrix<double> a(2, 3);
+	ASSERT_ANY_THROW(a.to_dense());
+	ASSERT_ANY_THROW(a.to_band());
+}
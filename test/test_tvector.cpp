@@ -185,3 +185,143 @@ TEST(TDynamicVector, cant_multiply_vectors_with_not_equal_size)
 	ASSERT_ANY_THROW(v1 * v2);
 }
 
+
+TEST(TDynamicVector, copy_shares_buffer_in_copy_on_write_mode)
+{
+	int a[] = { 1, 2, 3 };
+	TDynamicVector<int> v(a, 3);
+	v.set_storage(TStorage::CopyOnWrite);
+	v.share();
+	const TDynamicVector<int> v1(v);
+	EXPECT_EQ(as_const(v).data(), v1.data());
+	EXPECT_EQ(TStorage::CopyOnWrite, v1.storage());
+}
+
+TEST(TDynamicVector, write_detaches_copy_in_copy_on_write_mode)
+{
+	int a[] = { 1, 0, 0 };
+	TDynamicVector<int> v(a, 3);
+	v.set_storage(TStorage::CopyOnWrite);
+	TDynamicVector<int> v1(v);
+	v1[0] = 5;
+	EXPECT_EQ(1, as_const(v)[0]);
+	EXPECT_EQ(5, as_const(v1)[0]);
+	EXPECT_NE(as_const(v).data(), as_const(v1).data());
+}
+
+TEST(TDynamicVector, reference_taken_before_copy_doesnt_change_copy)
+{
+	TDynamicVector<double> v(3);
+	v.set_storage(TStorage::CopyOnWrite);
+	v.share();
+	auto r = v[0];
+	TDynamicVector<double> w = v;
+	r = 5.0;
+	EXPECT_EQ(5.0, as_const(v)[0]);
+	EXPECT_EQ(0.0, as_const(w)[0]);
+}
+
+TEST(TDynamicVector, reading_through_non_const_vector_keeps_buffer_shared)
+{
+	TDynamicVector<int> v(3);
+	v.set_storage(TStorage::CopyOnWrite);
+	v.share();
+	v[1] = 2;
+	const TDynamicVector<int> w(v);
+	int x = v[1] + v.at(1);
+	EXPECT_EQ(4, x);
+	EXPECT_EQ(as_const(v).data(), w.data());
+}
+
+TEST(TDynamicVector, pointer_taken_before_copy_on_write_doesnt_change_copy)
+{
+	TDynamicVector<int> v(3);
+	int* p = v.data();
+	v.set_storage(TStorage::CopyOnWrite);
+	TDynamicVector<int> w(v);
+	p[1] = 99;
+	EXPECT_EQ(99, as_const(v)[1]);
+	EXPECT_EQ(0, as_const(w)[1]);
+	v.share();
+	TDynamicVector<int> w1(v);
+	EXPECT_EQ(as_const(v).data(), as_const(w1).data());
+}
+
+TEST(TDynamicVector, owned_vector_never_shares_buffer)
+{
+	TDynamicVector<int> v(3);
+	v.set_storage(TStorage::CopyOnWrite);
+	TDynamicVector<int> v1(v);
+	v1.set_storage(TStorage::Owned);
+	EXPECT_NE(as_const(v).data(), as_const(v1).data());
+	TDynamicVector<int> v2(v1);
+	EXPECT_NE(as_const(v1).data(), as_const(v2).data());
+}
+
+TEST(TDynamicVector, assigned_vector_has_its_own_memory_without_copy_on_write)
+{
+	TDynamicVector<int> v(3), v1(3);
+	v1 = v;
+	EXPECT_NE(as_const(v).data(), as_const(v1).data());
+}
+
+TEST(TDynamicMatrix, copied_matrix_has_its_own_memory_in_copy_on_write_mode)
+{
+	TDynamicMatrix<int> m(2);
+	m.set_storage(TStorage::CopyOnWrite);
+	m[0][0] = 1; m[1][1] = 4;
+	TDynamicMatrix<int> m1(m);
+	m1[1][1] = 10;
+	EXPECT_EQ(4, as_const(m)[1][1]);
+	EXPECT_EQ(10, as_const(m1)[1][1]);
+	EXPECT_EQ(1, as_const(m1)[0][0]);
+	m1.transpose_inplace();
+	EXPECT_EQ(1, as_const(m)[0][0]);
+}
+
+TEST(TDynamicMatrix, row_reference_taken_before_copy_doesnt_change_copy)
+{
+	TDynamicMatrix<int> m(2);
+	m.set_storage(TStorage::CopyOnWrite);
+	TDynamicVector<int>& row = m[1];
+	int* p = row.data();
+	TDynamicMatrix<int> m1(m);
+	p[0] = 7;
+	row[1] = 8;
+	EXPECT_EQ(7, as_const(m)[1][0]);
+	EXPECT_EQ(8, as_const(m)[1][1]);
+	EXPECT_EQ(0, as_const(m1)[1][0]);
+	EXPECT_EQ(0, as_const(m1)[1][1]);
+}
+
+TEST(TDynamicMatrix, matrix_built_by_elements_shares_rows_after_share)
+{
+	TDynamicMatrix<int> m(3);
+	m.set_storage(TStorage::CopyOnWrite);
+	for (size_t i = 0; i < 3; i++)
+		for (size_t j = 0; j < 3; j++)
+			m[i][j] = int(i * 3 + j);
+	m.share();
+	TDynamicMatrix<int> m1(m);
+	for (size_t i = 0; i < 3; i++)
+		EXPECT_EQ(as_const(m)[i].data(), as_const(m1)[i].data());
+	m1[1][1] = -1;
+	EXPECT_EQ(4, as_const(m)[1][1]);
+	EXPECT_EQ(-1, as_const(m1)[1][1]);
+	EXPECT_EQ(as_const(m)[0].data(), as_const(m1)[0].data());
+}
+
+TEST(TDynamicMatrix, stale_reference_doesnt_leak_into_copy)
+{
+	TDynamicMatrix<int> b(3);
+	TDynamicVector<int>& row = b[1];
+	int* p = row.data();
+	b.set_storage(TStorage::CopyOnWrite);
+	TDynamicMatrix<int> c(b);
+	row[1] = 99;
+	p[2] = 98;
+	EXPECT_EQ(99, as_const(b)[1][1]);
+	EXPECT_EQ(98, as_const(b)[1][2]);
+	EXPECT_EQ(0, as_const(c)[1][1]);
+	EXPECT_EQ(0, as_const(c)[1][2]);
+}